@@ -18,8 +18,10 @@ import multiprocessing as mp
 # Add our lib directory to the PYTHONPATH, and load our utilitary libraries
 sys.path.append(f'{os.path.dirname(os.path.abspath(__file__))}/scripts')
 
+import MBIutils
 from MBIutils import *
 from LaTeXutils import *
+from MBIscheduler import *
 
 # Plots need big dependancy like numpy and matplotlib, so just ignore
 # the import if dependencies are not available.
@@ -79,23 +81,34 @@ def extract_all_todo(batch):
     else:
         subprocess.run("ls ../..", shell=True)
         raise Exception(f"Cannot find the input codes (cwd: {os.getcwd()}). Did you run the generators before running the tests?")
+    global todo
+    filenames = sorted(filenames)
+    # The tests declared by each code are read from the index of the codes, as long as the codes did not change since
+    if len(filenames) > 0:
+        MBIutils.code_index = CodeIndex(os.path.dirname(filenames[0]))
+    if batch == 'queue': # All runners share the same queue of tests, see cmd_run()
+        print(f'Handling all {len(filenames)} files in {os.getcwd()}, from a queue shared by all runners')
+        for filename in filenames:
+            todo = todo + MBIutils.code_index.tests(filename)
+        MBIutils.code_index.save(filenames)
+        return
+
     # Choose the files that will be used by this runner, depending on the -b argument
     match = re.match('(\d+)/(\d+)', batch)
     if not match:
-        print(f"The parameter to batch option ({batch}) is invalid. Must be something like 'N/M', with N and M numbers.")
+        print(f"The parameter to batch option ({batch}) is invalid. Must be something like 'N/M', with N and M numbers, or 'queue'.")
     pos = int(match.group(1))
     runner_count = int(match.group(2))
     assert pos > 0
     assert pos <= runner_count
     batch = int(len(filenames) / runner_count)+1
     min_rank = batch*(pos-1)
-    max_rank = (batch*pos)-1
+    max_rank = min(batch*pos, len(filenames))-1
     print(f'Handling files from #{min_rank} to #{max_rank}, out of {len(filenames)} in {os.getcwd()}')
 
-    global todo
-    filename = sorted(filenames)
-    for filename in filenames[min_rank:max_rank]:
-        todo = todo + parse_one_code(filename)
+    for filename in filenames[min_rank:max_rank+1]:
+        todo = todo + MBIutils.code_index.tests(filename)
+    MBIutils.code_index.save(filenames)
     if pos == runner_count and pos != 1: # The last runner starts from the end of the array to ease dynamically splitting
         todo = list(reversed(todo))
 
@@ -119,23 +132,56 @@ def cmd_gencodes():
         dir = "gencodes/"
     else:
         raise Exception("Cannot find the codes' generators. Please report that bug.")
-    subprocess.run(f"rm -rf {dir} ; mkdir {dir}", shell=True, check=True)
+    # With a covering strength t, the generators only produce a subset of the combinations of calls of their loops, in which every t-tuple of calls appears (see generator_utils.covered())
+    os.environ['MBI_COVERING_STRENGTH'] = str(args.covering_strength)
+
+    # Generate all codes in a staging directory, and only replace the codes that changed, so that the other ones keep their date
+    staging = f"{dir.rstrip('/')}.new"
+    os.makedirs(dir, exist_ok=True)
+    subprocess.run(f"rm -rf {staging} ; mkdir {staging}", shell=True, check=True)
     here = os.getcwd()
-    os.chdir(dir)
-    print(f"Generate the codes (in {os.getcwd()}): ", end='')
+    os.chdir(staging)
+    # The generators write distinct files, so they run concurrently, each of them in a process of the pool
+    generators = sorted(generators)
+    jobs = min(len(os.sched_getaffinity(0)), len(generators))
+    print(f"Generate the codes (in {os.getcwd()}, with {jobs} process{'es' if jobs > 1 else ''}): ", end='')
+    names = []
     for generator in generators:
         m = re.match("^.*?/([^/]*)Generator.py$", generator)
         if m:
-            print(m.group(1), end=", ")
+            names.append(m.group(1))
         else:
-            print(generator, end=", ")
-        subprocess.run(f'../scripts/ensure_python3 {generator}', shell=True, check=True)
-    print("\nTest count: ", end='')
+            names.append(generator)
+        print(names[-1], end=", ")
+    print("")
     sys.stdout.flush()
-    subprocess.run("ls *.c|wc -l", shell=True, check=True)
-    subprocess.run("for n in *.c ; do cat -n $n > $n.txt ; done", shell=True, check=True)
+    start = time.time()
+    with mp.Pool(jobs, initializer=init_generator_worker, initargs=(os.path.dirname(generators[0]),)) as pool:
+        results = pool.map(run_generator, generators, chunksize=1)
+    elapsed = time.time() - start
+    count = len(glob.glob('*.c'))
+    print(f"Test count: {count} codes (and their numbered .c.txt view) generated in {elapsed:.2f} seconds, {count/elapsed:.0f} files/sec.")
     os.chdir(here)
 
+    changes = update_generated(staging, dir.rstrip('/'), {name: generated for (name, (generated, skipped)) in zip(names, results)})
+    skipped = {name: skipped for (name, (generated, skipped)) in zip(names, results) if len(skipped) > 0}
+    if args.covering_strength > 0:
+        with open(f"{dir.rstrip('/')}/covering.json", 'w') as outfile:
+            json.dump({'strength': args.covering_strength, 'skipped': skipped}, outfile, indent=1, sort_keys=True)
+        print(f"Covering array of strength {args.covering_strength}: {sum(len(combinations) for combinations in skipped.values())} combinations of calls skipped (listed in {dir.rstrip('/')}/covering.json).")
+    elif os.path.exists(f"{dir.rstrip('/')}/covering.json"):
+        os.remove(f"{dir.rstrip('/')}/covering.json")
+    if len(changes) == 0:
+        print(f"No code changed in {dir}.")
+    for (name, change) in sorted(changes.items()):
+        print(f"Generator {name} changed the codes of {dir}: {change['added']} added, {change['changed']} modified, {change['removed']} removed.")
+
+    # Index the tests of the codes, so that the other commands don't parse all headers. Only the changed codes are parsed again
+    index = CodeIndex(dir.rstrip('/'))
+    filenames = sorted(glob.glob(f"{dir.rstrip('/')}/*.c"))
+    print(f"Index of the codes: {sum(len(index.entry(filename)['tests']) for filename in filenames)} tests in {index.filename}.")
+    index.save(filenames)
+
 
 ########################
 # cmd_build(): what to do when '-c build' is used (building the tool, discarding the cache)
@@ -150,6 +196,57 @@ def cmd_build(rootdir, toolname):
 ########################
 # cmd_run(): what to do when '-c run' is used (running the tests)
 ########################
+def test_id(test):
+    binary = re.sub('\.c', '', os.path.basename(test['filename']))
+    return f"{binary}_{test['id']}"
+
+def setup_tool(rootdir, toolname):
+    """Pass the settings of the command line to the tool wrapper"""
+    tools[toolname].set_rootdir(rootdir)
+    tools[toolname].output_cap = args.output_cap
+    tools[toolname].mem_limit = args.mem_limit
+    tools[toolname].cpu_limit = args.cpu_limit
+    tools[toolname].pids_limit = args.pids_limit
+    tools[toolname].use_pch = not args.no_pch
+
+def plan_campaign(toolname, cores):
+    """The tests of the campaign of that tool (from its logs directory), in the order in which they should be run, without the ones already done according to the run journal"""
+    # Start with the tests that are expected to last longer, to not end the campaign with a long test running alone
+    if args.order == 'expected':
+        model = RuntimeModel(todo, test_id, args.timeout)
+        model.sort(todo)
+        if len(model.history) > 0:
+            expected = sum(model.predict(test) for test in todo)
+            print(f"Tests sorted longest-expected-first ({len(model.history)} out of {len(todo)} already ran once). Expected duration: {seconds2human(expected/cores)} on {cores} core{'s' if cores > 1 else ''}.")
+
+    # Run the deterministic tests several times to get robust timings. The repetitions are separate tests (with their own logs and cache), run after all the others
+    runs = todo
+    if args.repeat_timing > 1:
+        repeats = [dict(test, id=f"{test['id']}-rep{rep}") for rep in range(1, args.repeat_timing) for test in todo if possible_details[test['detail']] not in nondeterministic_scopes]
+        print(f"Timing each deterministic test over {args.repeat_timing} runs: {len(repeats)} repetitions added to the {len(todo)} tests.")
+        runs = todo + repeats
+
+    # Resume an interrupted campaign: the tests that were running when it stopped are cleaned up to be run again,
+    # and the ones already done with the same settings are skipped without hashing their source again
+    journal = RunJournal()
+    events = journal.replay()
+    interrupted = [name for (name, event) in events.items() if journal.interrupted(event)]
+    if len(interrupted) > 0:
+        for name in interrupted:
+            for ext in stored_extensions + ['txt.gz']:
+                if os.path.exists(f'{name}.{ext}'):
+                    os.remove(f'{name}.{ext}')
+            if ResultStore.available() and os.path.exists('results.db'):
+                ResultStore('results.db').forget(name)
+        print(f"{len(interrupted)} test{'s were' if len(interrupted) > 1 else ' was'} interrupted in a previous run. Their partial results were removed, and they will be run again.")
+    journal.compact(forget=interrupted) # Only keep the last event of each test, to not replay all campaigns next time
+    journal.expire_leases()
+    done = set(id(test) for test in runs if test_id(test) in events and tools[toolname].journaled(events[test_id(test)], test['filename'], test['cmd'], args.timeout, test.get('np', 1)))
+    if len(done) > 0:
+        print(f"Resuming from the run journal: {len(done)} tests already done are skipped, {len(runs) - len(done)} remain.")
+        runs = [test for test in runs if id(test) not in done]
+    return runs
+
 def cmd_run(rootdir, toolname, batchinfo):
     # Go to the tools' logs directory on need
     rootdir = os.path.dirname(os.path.abspath(__file__))
@@ -157,7 +254,16 @@ def cmd_run(rootdir, toolname, batchinfo):
     os.chdir(f'{rootdir}/logs/{toolname}')
     print(f"Run tool {toolname} from {os.getcwd()} (batch {batchinfo}).")
 
-    tools[toolname].set_rootdir(rootdir)
+    setup_tool(rootdir, toolname)
+    if args.scratch is not None:
+        os.makedirs(args.scratch, exist_ok=True)
+        tools[toolname].scratch_root = os.path.abspath(args.scratch)
+        fstype = filesystem_type(args.scratch)
+        print(f"The tests are built and run in {tools[toolname].scratch_root} ({fstype or 'unknown'} file system){'' if fstype in ['tmpfs', 'ramfs'] else ', which does not seem to be RAM-backed'}.")
+    if tools[toolname].limits() is not None:
+        # Confine each test to its own cgroup. This must be prepared before forking the workers
+        setup_cgroups([controller for (controller, limit) in [('memory', args.mem_limit), ('cpu', args.cpu_limit), ('pids', args.pids_limit)] if limit > 0])
+        print(f"Each test is confined to a budget of {args.mem_limit or 'unlimited'} MiB, {args.cpu_limit or 'unlimited'} cores and {args.pids_limit or 'unlimited'} processes per MPI process.")
 
     # Basic verification
     tools[toolname].ensure_image()
@@ -165,24 +271,164 @@ def cmd_run(rootdir, toolname, batchinfo):
     # Build the tool on need
     tools[toolname].build(rootdir=rootdir)
 
+    # How many cores can we use at once?
+    cores = args.jobs if args.jobs > 0 else len(os.sched_getaffinity(0)) # The CPUs we are allowed to use, not all the CPUs of the machine
+    if cores > 1 and not tools[toolname].parallel_safe:
+        print(f"Tool {toolname} cannot run several tests at once. Ignoring '-j {args.jobs}' and running the tests one after the other.")
+        cores = 1
+    elif cores > 1:
+        print(f"Running the tests on {cores} cores.")
+
+    if batchinfo == 'worker':
+        # The tests were planned by the coordinator, that wrote their description in the queue
+        queue = WorkQueue(os.getcwd(), lease=args.timeout+120)
+        if not queue.attach(wait=300):
+            print(f"No queue was prepared by a coordinator in {os.getcwd()}. Nothing to do for {toolname}.")
+            tools[toolname].teardown()
+            return
+        runs = queue.items
+    else:
+        runs = plan_campaign(toolname, cores)
+
+    # Take our lease before forking the tests, so that they share it (see RunJournal)
+    RunJournal().lease()
+
     count = 1
-    for test in todo:
+    def make_process(test, placement):
+        nonlocal count
         binary = re.sub('\.c', '', os.path.basename(test['filename']))
 
-        print(f"\nTest #{count} out of {len(todo)}: '{binary}_{test['id']} '", end="... ")
+        print(f"\nTest #{count} out of {len(runs)}: '{binary}_{test['id']} '", end="... ")
         count += 1
-        sys.stdout.flush()
 
-        p = mp.Process(target=tools[toolname].run, args=(test['cmd'], test['filename'], binary, test['id'], args.timeout, batchinfo))
-        p.start()
-        sys.stdout.flush()
-        p.join(args.timeout+60)
-        if p.is_alive():
-            print("HARD TIMEOUT! The child process failed to timeout by itself. Sorry for the output.")
-            p.terminate()
+        seed = repeat_seed(test_id(test)) if repeat_group(test) is not None else None
+        return mp.Process(target=run_and_record, args=(tools[toolname], test['cmd'], test['filename'], binary, test['id'], args.timeout, batchinfo, test.get('np', 1), placement, seed))
+
+    def make_prebuild(test):
+        binary = re.sub('\.c', '', os.path.basename(test['filename']))
+        return mp.Process(target=prebuild_test, args=(tools[toolname], test['cmd'], test['filename'], binary, test['id'], args.timeout, batchinfo, test.get('np', 1)))
+
+    # The repeats of a nondeterministic test are not started once the other ones settled its class (such as a CTP, with both a TP and a FN)
+    pending = set(name if type(name) is str else test_id(name) for name in runs) # The tests of this campaign that are not done yet
+    def on_done(test):
+        pending.discard(test_id(test))
+        if batchinfo == 'queue' or batchinfo == 'worker':
+            queue.done(test_id(test))
+
+    def skip(test):
+        group = repeat_group(test)
+        if group is None or args.all_repeats:
+            return False
+        binary = re.sub('\.c', '', os.path.basename(test['filename']))
+        results = []
+        for num in range(group[1], group[1] + repeat_count):
+            sibling = f"{binary}_{num}"
+            if sibling in pending or skipped_repeat(toolname, sibling) or not has_result(sibling):
+                continue
+            try:
+                results.append(categorize(tool=tools[toolname], toolname=toolname, test_id=sibling, expected=test['expect'])[0])
+            except ValueError: # Half-written result
+                pass
+        settled = settled_category(results, test['expect'])
+        if settled is None:
+            return False
+        with open(f'{test_id(test)}.skipped', 'w') as outfile:
+            outfile.write(f"{settled}\n")
+        print(f"\nSkipping test {test_id(test)}: its other repeats already make it a {settled}.")
+        on_done(test)
+        return True
+
+    if batchinfo == 'queue' or batchinfo == 'worker':
+        # Pull the tests one at a time from a queue shared with the other runners. A test is given to another runner if we don't complete it within the hard timeout
+        # The builds are not pipelined here: pulling the tests in advance would start their lease before they run
+        if batchinfo == 'queue':
+            queue = WorkQueue(os.getcwd(), lease=args.timeout+120)
+            tests = queue.tests(runs, test_id)
+        else: # The paths of the codes are relative to the root directory, that may be mounted elsewhere in the container of the coordinator
+            tests = queue.pulled({name: dict(job, filename=os.path.join(rootdir, job['filename'])) for (name, job) in queue.jobs.items()})
+        Scheduler(cores, pinning=args.pin).run(tests, make_process, hard_timeout=args.timeout+60, on_done=on_done, skip=skip)
+    else:
+        # Compile the upcoming tests while the current ones are analyzed
+        scheduler = Scheduler(cores, compile_workers=args.compile_jobs, pinning=args.pin)
+        scheduler.run(runs, make_process, hard_timeout=args.timeout+60, on_done=on_done, make_prebuild=make_prebuild, skip=skip)
+        if scheduler.pipeline_report() is not None:
+            print(scheduler.pipeline_report())
 
     tools[toolname].teardown()
 
+########################
+# cmd_coordinate(): what to do when '-c coordinate' is used (sharing the campaigns of several tools between workers)
+########################
+def cmd_coordinate(rootdir, toolnames):
+    # Plan the campaign of each tool, and publish its tests in a queue of its logs directory
+    cores = args.jobs if args.jobs > 0 else len(os.sched_getaffinity(0))
+    queues = {}
+    for toolname in toolnames:
+        if tools[toolname] is None:
+            print(f"Cannot coordinate the campaign of {toolname}, whose wrapper cannot be loaded here.")
+            continue
+        os.makedirs(f'{rootdir}/logs/{toolname}', exist_ok=True)
+        os.chdir(f'{rootdir}/logs/{toolname}')
+        print(f"Plan the campaign of {toolname} in {os.getcwd()}.")
+        setup_tool(rootdir, toolname)
+        runs = plan_campaign(toolname, cores)
+        queues[toolname] = WorkQueue(os.getcwd(), lease=args.timeout+120)
+        if len(runs) > 0:
+            queues[toolname].join([test_id(test) for test in runs], jobs={test_id(test): dict(test, filename=os.path.relpath(test['filename'], rootdir)) for test in runs})
+    os.chdir(rootdir)
+    print(f"Waiting for the workers (started with '-c worker -x <tool>' on the same logs directories, with the same settings).")
+
+    # Show the progress of all campaigns until they are all done. The queue of a tool is removed by its last worker
+    totals = {}
+    previous = None
+    while True:
+        status = []
+        (done, total, running, runners) = (0, 0, 0, set())
+        for (toolname, queue) in queues.items():
+            progress = queue.progress()
+            if progress is None:
+                totals.setdefault(toolname, 0)
+                status.append(f"{toolname} {totals[toolname]}/{totals[toolname]}")
+                (done, total) = (done + totals[toolname], total + totals[toolname])
+                continue
+            totals[toolname] = progress['total']
+            status.append(f"{toolname} {progress['pulled'] - progress['running']}/{progress['total']}{' (' + str(progress['running']) + ' running)' if progress['running'] > 0 else ''}")
+            (done, total, running) = (done + progress['pulled'] - progress['running'], total + progress['total'], running + progress['running'])
+            runners |= progress['runners']
+        line = f"{', '.join(status)}. Total: {done}/{total} tests done ({percent(done, total) if total > 0 else 100}%), {running} running on {len(runners)} worker{'s' if len(runners) != 1 else ''}."
+        if line != previous:
+            print(f"[{time.strftime('%H:%M:%S')}] {line}")
+            sys.stdout.flush()
+            previous = line
+        if all(queue.progress() is None for queue in queues.values()):
+            break
+        time.sleep(10)
+    print("All campaigns are done.")
+
+########################
+# cmd_import() and cmd_export(): move the results of a tool between the per-test files and the result store
+########################
+def cmd_import(rootdir, toolname):
+    if not ResultStore.available():
+        print("This python has no sqlite3 module. Cannot use the result store.")
+        sys.exit(1)
+    if not os.path.exists(f'{rootdir}/logs/{toolname}'):
+        print(f"No results to import for {toolname}.")
+        return
+    store = ResultStore(f'{rootdir}/logs/{toolname}/results.db')
+    count = store.import_tree(tools[toolname], f'{rootdir}/logs/{toolname}')
+    print(f"Imported {count} results of {toolname} into {store.filename} ({len(store.test_ids())} results stored).")
+
+def cmd_export(rootdir, toolname):
+    if not ResultStore.available():
+        print("This python has no sqlite3 module. Cannot use the result store.")
+        sys.exit(1)
+    if not os.path.exists(f'{rootdir}/logs/{toolname}/results.db'):
+        print(f"No result store for {toolname}.")
+        return
+    count = ResultStore(f'{rootdir}/logs/{toolname}/results.db').export_tree(f'{rootdir}/logs/{toolname}')
+    print(f"Exported {count} results of {toolname} to {rootdir}/logs/{toolname}.")
+
 ########################
 # cmd_html(): what to do when '-c html' is used (extract the statistics of this tool)
 ########################
@@ -212,11 +458,26 @@ def seconds2human(secs):
     seconds = secs - days*86400 - hours*3600 - minutes*60
     return (f"{days} days, " if days else "") + (f"{hours} hours, " if hours else "") + (f"{minutes} minutes, " if minutes else "") + (f"{int(seconds*100)/100} seconds" if seconds else "")
 
+def bytes2human(amount):
+    """Returns the amount of bytes in human-friendly way"""
+    for unit in ['bytes', 'KiB', 'MiB', 'GiB']:
+        if amount < 1024:
+            return f"{round(amount, 1)} {unit}"
+        amount /= 1024
+    return f"{round(amount, 1)} TiB"
+
+def rss2human(mib):
+    """Returns a peak memory given in MiB (as computed by summarize_resources()), or a dash if unknown"""
+    return '-' if mib is None else f"{round(mib, 1)} MiB"
+
 def cmd_html(rootdir, toolnames=[]):
     here = os.getcwd()
     os.chdir(rootdir)
     results = {}
     total_elapsed = {}
+    resources = {}
+    phases = {}
+    medians = {}
     used_toolnames = []
     for toolname in toolnames:
         if not toolname in tools:
@@ -225,11 +486,18 @@ def cmd_html(rootdir, toolnames=[]):
         if os.path.exists(f'logs/{toolname}'):
             used_toolnames.append(toolname)
             # To compute statistics on the performance of this tool
-            results[toolname]= {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
+            results[toolname]= {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
 
             # To compute timing statistics
             total_elapsed[toolname] = 0
 
+            # To compute the resources and phase timings statistics, per error category
+            resources[toolname] = {error: [] for error in error_scope}
+            phases[toolname] = {error: [] for error in error_scope}
+
+            # Median time of the tests that were run several times (see --repeat-timing), per error category
+            medians[toolname] = {error: [] for error in error_scope}
+
     ########################
     # Analyse each test, grouped by expectation, and all tools for a given test
     ########################
@@ -343,9 +611,18 @@ iframe {
         outHTML.write("</td>")
 
         for toolname in used_toolnames:
+            if skipped_repeat(toolname, test_id):
+                outHTML.write(f"<td align='center'>skipped</td>")
+                continue
             (res_category, elapsed, diagnostic, outcome) = categorize(tool=tools[toolname], toolname=toolname, test_id=test_id, expected=expected, autoclean=True)
+            timings = summarize_timings(timing_samples(tools[toolname], toolname, test_id))
+            if timings is not None and timings['runs'] > 1:
+                medians[toolname][possible_details[test['detail']]].append(timings['median'])
+                diagnostic += f"; time {timings2human(timings)}"
 
             results[toolname][res_category].append(f"{test_id} expected {test['detail']}, outcome: {diagnostic}")
+            if store_of(toolname) is not None and not os.path.exists(f'logs/{toolname}/{test_id}.txt'): # The report links to the output of the tool, only kept in the result store
+                store_of(toolname).restore(test_id, f'logs/{toolname}', extensions=['txt', 'html'])
             outHTML.write(f"<td align='center'><a href='logs/{toolname}/{test_id}.txt' target='MBI_details'><img title='{displayed_name[toolname]} {diagnostic} (returned {outcome})' src='img/{res_category}.svg' width='24' /></a> ({outcome})")
             extra=None
 
@@ -367,6 +644,11 @@ iframe {
 
             if res_category != 'timeout' and elapsed is not None:
                 total_elapsed[toolname] += float(elapsed)
+            stats = read_stats(tools[toolname], toolname, test_id)
+            if 'resources' in stats:
+                resources[toolname][possible_details[test['detail']]].append(stats['resources'])
+            if 'phases' in stats:
+                phases[toolname][possible_details[test['detail']]].append(stats['phases'])
 
             if len(used_toolnames) == 1:
                 print(f"Test '{test_id}' result: {res_category}: {diagnostic}. Elapsed: {elapsed} sec")
@@ -379,7 +661,7 @@ iframe {
 
       # Display summary metrics for each tool
       def tool_stats(toolname):
-          return (len(results[toolname]['TRUE_POS']), len(results[toolname]['TRUE_NEG']),len(results[toolname]['FALSE_POS']),len(results[toolname]['FALSE_NEG']),len(results[toolname]['unimplemented']),len(results[toolname]['failure']),len(results[toolname]['timeout']),len(results[toolname]['other']))
+          return (len(results[toolname]['TRUE_POS']), len(results[toolname]['TRUE_NEG']),len(results[toolname]['FALSE_POS']),len(results[toolname]['FALSE_NEG']),len(results[toolname]['unimplemented']),len(results[toolname]['failure']),len(results[toolname]['timeout']),len(results[toolname]['memout']),len(results[toolname]['other']))
 
       outHTML.write("\n<a name='metrics'/><h2>Metrics</h2><table border=1>\n<tr><td/>\n")
       for toolname in used_toolnames:
@@ -387,34 +669,108 @@ iframe {
 
       outHTML.write("</tr>\n<tr><td>API coverage</td>")
       for toolname in used_toolnames:
-        (TP, TN, FP, FN, nPort, nFail, nTout, nNocc) = tool_stats(toolname)
-        total = TP + TN + FP + FN + nTout + nPort + nFail + nNocc
+        (TP, TN, FP, FN, nPort, nFail, nTout, nMem, nNocc) = tool_stats(toolname)
+        total = TP + TN + FP + FN + nTout + nMem + nPort + nFail + nNocc
         outHTML.write(f"<td><div class='tooltip'>{percent(nPort,total,compl=True)}% <span class='tooltiptext'>{nPort} unimplemented calls, {nNocc} inconclusive runs out of {total}</span></div></td>")
 
       outHTML.write("</tr>\n<tr><td>Robustness</td>")
       for toolname in used_toolnames:
-        (TP, TN, FP, FN, nPort, nFail, nTout, nNocc) = tool_stats(toolname)
-        totalPort = TP + TN + FP + FN + nTout + nFail
-        outHTML.write(f"<td><div class='tooltip'>{percent((nTout+nFail),(totalPort),compl=True)}% <span class='tooltiptext'>{nTout} timeouts, {nFail} failures out of {totalPort}</span></div></td>")
+        (TP, TN, FP, FN, nPort, nFail, nTout, nMem, nNocc) = tool_stats(toolname)
+        totalPort = TP + TN + FP + FN + nTout + nMem + nFail
+        outHTML.write(f"<td><div class='tooltip'>{percent((nTout+nMem+nFail),(totalPort),compl=True)}% <span class='tooltiptext'>{nTout} timeouts, {nMem} memouts, {nFail} failures out of {totalPort}</span></div></td>")
 
       outHTML.write("</tr>\n<tr><td>Recall</td>")
       for toolname in used_toolnames:
-        (TP, TN, FP, FN, nPort, nFail, nTout, nNocc) = tool_stats(toolname)
+        (TP, TN, FP, FN, nPort, nFail, nTout, nMem, nNocc) = tool_stats(toolname)
         outHTML.write(f"<td><div class='tooltip'>{percent(TP,(TP+FN))}% <span class='tooltiptext'>found {TP} errors out of {TP+FN}</span></div></td>")
       outHTML.write("</tr>\n<tr><td>Specificity</td>")
       for toolname in used_toolnames:
-        (TP, TN, FP, FN, nPort, nFail, nTout, nNocc) = tool_stats(toolname)
+        (TP, TN, FP, FN, nPort, nFail, nTout, nMem, nNocc) = tool_stats(toolname)
         outHTML.write(f"<td><div class='tooltip'>{percent(TN,(TN+FP))}%  <span class='tooltiptext'>recognized {TN} correct codes out of {TN+FP}</span></div></td>")
       outHTML.write("</tr>\n<tr><td>Precision</td>")
       for toolname in used_toolnames:
-        (TP, TN, FP, FN, nPort, nFail, nTout, nNocc) = tool_stats(toolname)
+        (TP, TN, FP, FN, nPort, nFail, nTout, nMem, nNocc) = tool_stats(toolname)
         outHTML.write(f"<td><div class='tooltip'>{percent(TP,(TP+FP))}% <span class='tooltiptext'>{TP} diagnostics of error are correct out of {TP+FP})</span></div></td>")
       outHTML.write("</tr>\n<tr><td>Accuracy</td>")
       for toolname in used_toolnames:
-        (TP, TN, FP, FN, nPort, nFail, nTout, nNocc) = tool_stats(toolname)
+        (TP, TN, FP, FN, nPort, nFail, nTout, nMem, nNocc) = tool_stats(toolname)
         outHTML.write(f"<td><div class='tooltip'>{percent((TP+TN),(TP+TN+FP+FN))}% <span class='tooltiptext'>{TP+TN} correct diagnostics in total, out of {TP+TN+FP+FN} diagnostics</span></div></td>")
       outHTML.write("</tr></table>")
-      outHTML.write("<p>Hover over the values for details. API coverage issues, timeouts and failures are not considered when computing the other metrics, thus differences in the total amount of tests.</p>")
+      outHTML.write("<p>Hover over the values for details. API coverage issues, timeouts, memouts and failures are not considered when computing the other metrics, thus differences in the total amount of tests.</p>")
+
+      # Display the time spent compiling the tests and analyzing them, overall and per error category
+      outHTML.write("\n<a name='timings'/><h2>Timings</h2><table border=1>\n<tr><td/>\n")
+      for toolname in used_toolnames:
+        outHTML.write(f"<td>{displayed_name[toolname]}</td>")
+      summaries = {toolname: summarize_phases([phase for error in error_scope for phase in phases[toolname][error]]) for toolname in used_toolnames}
+      for (title, show) in [("Measured tests", lambda r: r['tests']),
+                            ("Compile time", lambda r: f"{seconds2human(r['compile']) or '0'} ({r['compile_cached']} builds cached; {seconds2human(r['build']) or '0'} of actual builds)"),
+                            ("Analysis time", lambda r: seconds2human(r['analysis']) or '0'),
+                            ("Cleanup time", lambda r: seconds2human(r['cleanup']) or '0'),
+                            ("Mean compile time per test", lambda r: '-' if r['mean_compile'] is None else f"{round(r['mean_compile'], 2)} s"),
+                            ("Mean analysis time per test", lambda r: '-' if r['mean_analysis'] is None else f"{round(r['mean_analysis'], 2)} s"),
+                            ("Mean build time with / without precompiled header", lambda r: ' / '.join('-' if r[name] is None else f"{round(r[name], 2)} s" for name in ['mean_compile_pch', 'mean_compile_nopch']))]:
+        outHTML.write(f"</tr>\n<tr><td>{title}</td>")
+        for toolname in used_toolnames:
+          outHTML.write(f"<td>{show(summaries[toolname])}</td>")
+      outHTML.write("</tr></table>\n")
+
+      outHTML.write("<h3>Mean compile and analysis time per error category</h3><table border=1>\n<tr><td/>")
+      for toolname in used_toolnames:
+        outHTML.write(f"<td>{displayed_name[toolname]}</td>")
+      for error in error_scope:
+        outHTML.write(f"</tr>\n<tr><td>{displayed_name[error]}</td>")
+        for toolname in used_toolnames:
+          summary = summarize_phases(phases[toolname][error])
+          if summary['tests'] == 0:
+            outHTML.write("<td>-</td>")
+          else:
+            outHTML.write(f"<td>{round(summary['mean_compile'], 2)} s / {round(summary['mean_analysis'], 2)} s</td>")
+      outHTML.write("</tr></table>\n")
+      if any(len(medians[toolname][error]) > 0 for toolname in used_toolnames for error in error_scope):
+        outHTML.write("<h3>Median time of the repeated tests per error category</h3><table border=1>\n<tr><td/>")
+        for toolname in used_toolnames:
+          outHTML.write(f"<td>{displayed_name[toolname]}</td>")
+        for error in list(error_scope) + ['total']:
+          outHTML.write(f"</tr>\n<tr><td>{'All tests' if error == 'total' else displayed_name[error]}</td>")
+          for toolname in used_toolnames:
+            values = [median for scope in error_scope for median in medians[toolname][scope]] if error == 'total' else medians[toolname][error]
+            outHTML.write(f"<td>{timings2human(summarize_timings(values), 'tests')}</td>")
+        outHTML.write("</tr></table>\n")
+        outHTML.write("<p>Each deterministic test was run several times (see <tt>--repeat-timing</tt>). These are the statistics of the median time of these tests: median, interquartile range and 95% confidence interval of the median.</p>")
+      outHTML.write("<p>The compile time includes the link of the test. The mean build times only account for the tests that were not found in the build cache. The cleanup time is spent terminating what remains of the tool once its analysis is over.</p>")
+
+      # Display the resources used by each tool, overall and per error category
+      outHTML.write("\n<a name='resources'/><h2>Resources</h2><table border=1>\n<tr><td/>\n")
+      for toolname in used_toolnames:
+        outHTML.write(f"<td>{displayed_name[toolname]}</td>")
+      summaries = {toolname: summarize_resources([usage for error in error_scope for usage in resources[toolname][error]]) for toolname in used_toolnames}
+      for (title, show) in [("Measured tests", lambda r: r['tests']),
+                            ("CPU time (user+sys)", lambda r: seconds2human(r['cpu']) or '0'),
+                            ("Mean CPU time per test", lambda r: '-' if r['mean_cpu'] is None else f"{round(r['mean_cpu'], 2)} s"),
+                            ("Largest peak memory", lambda r: rss2human(r['max_rss'])),
+                            ("Mean peak memory", lambda r: rss2human(r['mean_rss'])),
+                            ("Major page faults", lambda r: r['major_faults']),
+                            ("Bytes read / written", lambda r: f"{bytes2human(r['read_bytes'])} / {bytes2human(r['written_bytes'])}"),
+                            ("Context switches", lambda r: r['switches'])]:
+        outHTML.write(f"</tr>\n<tr><td>{title}</td>")
+        for toolname in used_toolnames:
+          outHTML.write(f"<td>{show(summaries[toolname])}</td>")
+      outHTML.write("</tr></table>\n")
+
+      outHTML.write("<h3>Mean CPU time and largest peak memory per error category</h3><table border=1>\n<tr><td/>")
+      for toolname in used_toolnames:
+        outHTML.write(f"<td>{displayed_name[toolname]}</td>")
+      for error in error_scope:
+        outHTML.write(f"</tr>\n<tr><td>{displayed_name[error]}</td>")
+        for toolname in used_toolnames:
+          summary = summarize_resources(resources[toolname][error])
+          if summary['tests'] == 0:
+            outHTML.write("<td>-</td>")
+          else:
+            outHTML.write(f"<td>{round(summary['mean_cpu'], 2)} s / {rss2human(summary['max_rss'])}</td>")
+      outHTML.write("</tr></table>\n")
+      outHTML.write("<p>The peak memory is the one of the largest process run by the tool for a given test. Tests run before the resource accounting was introduced are not measured.</p>")
 
       # Add generate radar plots
       if plots_loaded:
@@ -435,8 +791,9 @@ iframe {
         nFail = len(results[toolname]['failure'])
         other = len(results[toolname]['other'])
         nTout = len(results[toolname]['timeout'])
+        nMem = len(results[toolname]['memout'])
         passed = TP + TN
-        total = passed + FP + FN + nTout + nPort + nFail + other
+        total = passed + FP + FN + nTout + nMem + nPort + nFail + other
 
         print(f"XXXXXXXXX Final results for {toolname}")
         if FP > 0:
@@ -454,6 +811,11 @@ iframe {
             if len(used_toolnames) == 1:
                 for p in results[toolname]['timeout']:
                     print(f"  {p}")
+        if nMem > 0:
+            print(f"XXX {nMem} memouts (memory budget exceeded)")
+            if len(used_toolnames) == 1:
+                for p in results[toolname]['memout']:
+                    print(f"  {p}")
         if nPort > 0:
             print(f"XXX {nPort} API coverage issues")
             if len(used_toolnames) == 1:
@@ -473,13 +835,19 @@ iframe {
         print(f"\nXXXX Summary for {toolname} XXXX  {passed} test{'' if passed == 1 else 's'} passed (out of {total})")
         print(f"API coverage: {percent(nPort,total,compl=True)}% ({nPort} tests failed out of {total})")
         print(
-            f"Robustness: {percent((nTout+nFail),(total-nPort),compl=True)}% ({nTout} timeouts and {nFail} failures out of {total-nPort})\n")
+            f"Robustness: {percent((nTout+nMem+nFail),(total-nPort),compl=True)}% ({nTout} timeouts, {nMem} memouts and {nFail} failures out of {total-nPort})\n")
 
         print(f"Recall: {percent(TP,(TP+FN))}% (found {TP} errors out of {TP+FN})")
         print(f"Specificity: {percent(TN,(TN+FP))}% (recognized {TN} correct codes out of {TN+FP})")
         print(f"Precision: {percent(TP,(TP+FP))}% ({TP} diagnostic of error are correct out of {TP+FP})")
         print(f"Accuracy: {percent((TP+TN),(TP+TN+FP+FN))}% ({TP+TN} correct diagnostics in total, out of {TP+TN+FP+FN} diagnostics)")
         print(f"\nTotal time of {toolname} for all tests (not counting the timeouts): {seconds2human(total_elapsed[toolname])} ({total_elapsed[toolname]} seconds)")
+        repeated = [median for error in error_scope for median in medians[toolname][error]]
+        if len(repeated) > 0:
+            print(f"Sum of the median times of the {len(repeated)} tests run several times: {seconds2human(sum(repeated))} (median test: {timings2human(summarize_timings(repeated), 'tests')})")
+        summary = summarize_phases([phase for error in error_scope for phase in phases[toolname][error]])
+        if summary['tests'] > 0:
+            print(f"Time of {toolname} per phase for the {summary['tests']} measured tests: compile {seconds2human(summary['compile']) or '0'} ({summary['compile_cached']} builds cached; {seconds2human(summary['build']) or '0'} of actual builds), analysis {seconds2human(summary['analysis']) or '0'}, cleanup {seconds2human(summary['cleanup']) or '0'}")
 
     os.chdir(here)
 
@@ -507,16 +875,31 @@ def cmd_latex(rootdir, toolnames):
     # Initialize the data structure to gather all results
     results = {'total':{}, 'error':{}}
     timing = {'total':{}, 'error':{}}
+    resources = {'total':{}, 'error':{}}
+    phases = {'total':{}, 'error':{}}
+    medians = {'total':{}, 'error':{}} # Median time of the tests run several times (see --repeat-timing)
     for error in error_scope:
         results[error] = {}
         timing[error] = {}
+        resources[error] = {}
+        phases[error] = {}
+        medians[error] = {}
         for toolname in used_toolnames:
-            results[error][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
-            results['total'][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
-            results['error'][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
+            results[error][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
+            results['total'][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
+            results['error'][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
             timing[error][toolname] = []
             timing['total'][toolname] = []
             timing['error'][toolname] = []
+            resources[error][toolname] = []
+            resources['total'][toolname] = []
+            resources['error'][toolname] = []
+            phases[error][toolname] = []
+            phases['total'][toolname] = []
+            phases['error'][toolname] = []
+            medians[error][toolname] = []
+            medians['total'][toolname] = []
+            medians['error'][toolname] = []
 
     # Get all data from the caches
     for test in todo:
@@ -526,18 +909,40 @@ def cmd_latex(rootdir, toolnames):
         expected=test['expect']
 
         for toolname in used_toolnames:
+            if skipped_repeat(toolname, test_id):
+                continue
             (res_category, elapsed, diagnostic, outcome) = categorize(tool=tools[toolname], toolname=toolname, test_id=test_id, expected=expected)
             error = possible_details[test['detail']]
             results[error][toolname][res_category].append(test_id)
             results['total'][toolname][res_category].append(test_id)
             timing[error][toolname].append(float(elapsed))
             timing['total'][toolname].append(float(elapsed))
+            stats = read_stats(tools[toolname], toolname, test_id)
+            usage = stats.get('resources')
+            if usage is not None:
+                resources[error][toolname].append(usage)
+                resources['total'][toolname].append(usage)
+            phase = stats.get('phases')
+            if phase is not None:
+                phases[error][toolname].append(phase)
+                phases['total'][toolname].append(phase)
+            timings = summarize_timings(timing_samples(tools[toolname], toolname, test_id))
+            median = timings['median'] if timings is not None and timings['runs'] > 1 else None
+            if median is not None:
+                medians[error][toolname].append(median)
+                medians['total'][toolname].append(median)
             if expected == 'OK':
                 results['total'][toolname]['OK'].append(test_id)
             else:
                 results['total'][toolname]['error'].append(test_id)
                 results['error'][toolname][res_category].append(test_id)
                 timing['error'][toolname].append(float(elapsed))
+                if usage is not None:
+                    resources['error'][toolname].append(usage)
+                if phase is not None:
+                    phases['error'][toolname].append(phase)
+                if median is not None:
+                    medians['error'][toolname].append(median)
 
     # Produce the results per tool and per category
     with open(f'{rootdir}/latex/results-per-category-landscape.tex', 'w') as outfile:
@@ -564,11 +969,11 @@ def cmd_latex(rootdir, toolnames):
                 port = len(results[error][toolname]['unimplemented'])
                 othr = len(results[error][toolname]['other'])
                 fail = len(results[error][toolname]['failure'])
-                tout = len(results[error][toolname]['timeout'])
+                tout = len(results[error][toolname]['timeout']) + len(results[error][toolname]['memout'])
                 good = len(results[error][toolname]['TRUE_POS']) + len(results[error][toolname]['TRUE_NEG'])
                 bad  = len(results[error][toolname]['FALSE_POS']) + len(results[error][toolname]['FALSE_NEG'])
                 outfile.write(f"&{port+othr} & {fail+tout} &{bad}&{good}")
-                #results[error][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
+                #results[error][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
             outfile.write("\\\\\\hline\n")
         outfile.write("\\hline\n \\textbf{Total}")
         for toolname in used_toolnames:
@@ -577,7 +982,7 @@ def cmd_latex(rootdir, toolnames):
                 port += len(results[error][toolname]['unimplemented'])
                 othr += len(results[error][toolname]['other'])
                 fail += len(results[error][toolname]['failure'])
-                tout += len(results[error][toolname]['timeout'])
+                tout += len(results[error][toolname]['timeout']) + len(results[error][toolname]['memout'])
                 good += len(results[error][toolname]['TRUE_POS']) + len(results[error][toolname]['TRUE_NEG'])
                 bad  += len(results[error][toolname]['FALSE_POS']) + len(results[error][toolname]['FALSE_NEG'])
             outfile.write(f"&{port+othr} & {fail+tout} &{bad}&{good}")
@@ -630,7 +1035,7 @@ def cmd_latex(rootdir, toolnames):
                     port = len(results[error][toolname]['unimplemented'])
                     othr = len(results[error][toolname]['other'])
                     fail = len(results[error][toolname]['failure'])
-                    tout = len(results[error][toolname]['timeout'])
+                    tout = len(results[error][toolname]['timeout']) + len(results[error][toolname]['memout'])
                     good = len(results[error][toolname]['TRUE_POS']) + len(results[error][toolname]['TRUE_NEG'])
                     bad  = len(results[error][toolname]['FALSE_POS']) + len(results[error][toolname]['FALSE_NEG'])
                     if good == best[error]: # Best tool is diplayed in bold
@@ -643,7 +1048,7 @@ def cmd_latex(rootdir, toolnames):
             for error in errors:
                 toolname = used_toolnames[0]
                 total  = len(results[error][toolname]['unimplemented']) + len(results[error][toolname]['other']) + len(results[error][toolname]['failure'])
-                total += len(results[error][toolname]['timeout']) + len(results[error][toolname]['TRUE_POS']) + len(results[error][toolname]['TRUE_NEG'])
+                total += len(results[error][toolname]['timeout']) + len(results[error][toolname]['memout']) + len(results[error][toolname]['TRUE_POS']) + len(results[error][toolname]['TRUE_NEG'])
                 total += len(results[error][toolname]['FALSE_POS']) + len(results[error][toolname]['FALSE_NEG'])
 
                 outfile.write(f"& \\textit{{0}} &\\textit{{0}} & \\textit{{0}} & \\textit{total} \n")
@@ -679,7 +1084,7 @@ def cmd_latex(rootdir, toolnames):
             port = len(results['total'][toolname]['unimplemented'])
             fail = len(results['total'][toolname]['failure'])
             othr = len(results['total'][toolname]['other'])
-            tout = len(results['total'][toolname]['timeout'])
+            tout = len(results['total'][toolname]['timeout']) + len(results['total'][toolname]['memout'])
             total = TP + TN + FP + FN + port + fail + othr + tout
             if (TN+FP) != 0 and TP+FN != 0 and TP+FP != 0:
                 coverage = float(percent(port,total,compl=True,one=True))
@@ -723,7 +1128,7 @@ def cmd_latex(rootdir, toolnames):
             port = len(results['total'][toolname]['unimplemented'])
             fail = len(results['total'][toolname]['failure'])
             othr = len(results['total'][toolname]['other'])
-            tout = len(results['total'][toolname]['timeout'])
+            tout = len(results['total'][toolname]['timeout']) + len(results['total'][toolname]['memout'])
             TP = len(results['total'][toolname]['TRUE_POS'])
             TN = len(results['total'][toolname]['TRUE_NEG'])
             FN = len(results['total'][toolname]['FALSE_NEG'])
@@ -779,7 +1184,7 @@ def cmd_latex(rootdir, toolnames):
 
             nPort = len(results['total'][toolname]['unimplemented'])
             nFail = len(results['total'][toolname]['failure']) + len(results['total'][toolname]['other'])
-            nTout = len(results['total'][toolname]['timeout'])
+            nTout = len(results['total'][toolname]['timeout']) + len(results['total'][toolname]['memout'])
             TP = len(results['total'][toolname]['TRUE_POS'])
             TN = len(results['total'][toolname]['TRUE_NEG'])
             FN = len(results['total'][toolname]['FALSE_NEG'])
@@ -818,8 +1223,9 @@ def cmd_latex(rootdir, toolnames):
             outfile.write(f"& {displayed_name[t]}")
         outfile.write(f"\\\\\\hline\n")
 
+        repeated = any(len(medians['total'][toolname]) > 0 for toolname in used_toolnames)
         def show_line(key, display_name):
-            outfile.write(f"\\multirow{{3}}{{*}}{{{display_name}}} & Mean time ")
+            outfile.write(f"\\multirow{{{8 if repeated else 5}}}{{*}}{{{display_name}}} & Mean time ")
             for toolname in used_toolnames:
                 if len(timing[key][toolname]) >1:
                     mean = statistics.mean(timing[key][toolname])
@@ -839,6 +1245,23 @@ def cmd_latex(rootdir, toolnames):
                     print(f"Error while computing the variance of timing[{key}][{toolname}] (needs at least two values)")
             outfile.write(f"\\\\\\cline{{2-{len(used_toolnames)+2}}}\n")
 
+            summaries = {toolname: summarize_phases(phases[key][toolname]) for toolname in used_toolnames}
+            for (title, name) in [('Mean compile', 'mean_compile'), ('Mean analysis', 'mean_analysis')]:
+                outfile.write(f"& {title} ")
+                for toolname in used_toolnames:
+                    mean = summaries[toolname][name]
+                    outfile.write("&-" if mean is None else f"&{round(mean,2)}")
+                outfile.write(f"\\\\\\cline{{2-{len(used_toolnames)+2}}}\n")
+
+            if repeated: # Statistics of the median time of the tests that were run several times
+                summaries = {toolname: summarize_timings(medians[key][toolname]) for toolname in used_toolnames}
+                for (title, show) in [('Median', lambda r: f"{round(r['median'],2)}"), ('IQR', lambda r: f"{round(r['iqr'],2)}"),
+                                      ('95\\% CI', lambda r: '-' if r['ci'] is None else f"[{round(r['ci'][0],2)}, {round(r['ci'][1],2)}]")]:
+                    outfile.write(f"& {title} ")
+                    for toolname in used_toolnames:
+                        outfile.write("&-" if summaries[toolname] is None else f"&{show(summaries[toolname])}")
+                    outfile.write(f"\\\\\\cline{{2-{len(used_toolnames)+2}}}\n")
+
             outfile.write(f" & \\# timout ")
             for toolname in used_toolnames:
                 tout = len(results[key][toolname]['timeout'])
@@ -884,6 +1307,56 @@ def cmd_latex(rootdir, toolnames):
         outfile.write(f"\\end{{tabular}}\n")
 
 
+    # Produce the resources used by each tool
+    with open(f'{rootdir}/latex/results-resources.tex', 'w') as outfile:
+        outfile.write(f"\\begin{{tabular}}{{|c|c|*{{{len(used_toolnames)}}}{{c|}}}}\n")
+        outfile.write(f"\\cline{{3-{len(used_toolnames)+2}}}\n")
+        # First title line: Tool names
+        outfile.write("  \\multicolumn{2}{c|}{}")
+        for t in used_toolnames:
+            outfile.write(f"& {displayed_name[t]}")
+        outfile.write(f"\\\\\\hline\n")
+
+        def show_resources(key, display_name):
+            summaries = {toolname: summarize_resources(resources[key][toolname]) for toolname in used_toolnames}
+            outfile.write(f"\\multirow{{3}}{{*}}{{{display_name}}} & Mean CPU time (s) ")
+            for toolname in used_toolnames:
+                mean = summaries[toolname]['mean_cpu']
+                outfile.write("&-" if mean is None else f"&{round(mean,2)}")
+            outfile.write(f"\\\\\\cline{{2-{len(used_toolnames)+2}}}\n")
+
+            outfile.write(f"& Peak memory (MiB) ")
+            for toolname in used_toolnames:
+                peak = summaries[toolname]['max_rss']
+                outfile.write("&-" if peak is None else f"&{round(peak)}")
+            outfile.write(f"\\\\\\cline{{2-{len(used_toolnames)+2}}}\n")
+
+            outfile.write(f" & \\# memout ")
+            for toolname in used_toolnames:
+                mout = len(results[key][toolname]['memout'])
+                outfile.write(f"&{mout if mout > 0 else '-'}")
+            outfile.write("\\\\\\hline\n")
+
+        for error in error_scope:
+            if error == 'FOK':
+                outfile.write('\\hline\n')
+                show_resources('error', '\\textit{All incorrect tests}')
+                title = '\\textit{All correct tests}'
+            else:
+                title = f"\\makecell{{{displayed_name[error]} \\\\ ({error_scope[error]})}}"
+
+            show_resources(error, title)
+        outfile.write('\\hline\n')
+        show_resources('total', '\\textbf{All tests}')
+
+        # Last line: Tool names again
+        outfile.write("  \\multicolumn{2}{c|}{}")
+        for t in used_toolnames:
+            outfile.write(f"& {displayed_name[t]}")
+        outfile.write(f"\\\\\\cline{{3-{len(used_toolnames)+2}}}\n")
+
+        outfile.write(f"\\end{{tabular}}\n")
+
     with open(f'{rootdir}/latex/nondeterministic-results-summary.tex', 'w') as outfile:
         outfile.write('\\setlength\\tabcolsep{2pt}\n')
         outfile.write('\\begin{tabular}{|l|*{1}{c|}|*{6}{c|}|*{2}{c|}}\\hline\n')
@@ -1202,6 +1675,8 @@ def cmd_latex(rootdir, toolnames):
                 binary=re.sub('\.c', '', os.path.basename(test['filename']))
                 ID=test['id']
                 test_id = f"{binary}_{ID}"
+                if skipped_repeat(toolname, test_id):
+                    continue
 
                 (res_category, elapsed, diagnostic, outcome) = categorize(tool=tools[toolname], toolname=toolname, test_id=test_id, expected=test['expect'], autoclean=False)
 
@@ -1277,7 +1752,7 @@ def make_radar_plot(name, errors, toolname, results, ext):
         score = 0.0
         if len(results['total'][toolname][TP]) != 0:
             total = 0.0
-            for r in ['failure', 'timeout', 'unimplemented', 'other',
+            for r in ['failure', 'timeout', 'memout', 'unimplemented', 'other',
                       'TRUE_NEG', 'TRUE_POS', 'FALSE_NEG', 'FALSE_POS']:
                 total += len(results[error][toolname][r])
             if total != 0:
@@ -1354,7 +1829,7 @@ def make_radar_plot_ext(name, errors, toolname, results, ext):
         score = 0.0
         if len(results['total'][toolname][TP]) != 0:
             total = 0.0
-            for r in ['failure', 'timeout', 'unimplemented', 'other',
+            for r in ['failure', 'timeout', 'memout', 'unimplemented', 'other',
                       'TRUE_NEG', 'TRUE_POS', 'FALSE_NEG', 'FALSE_POS']:
                 total += len(results[error][toolname][r])
             if total != 0:
@@ -1436,6 +1911,27 @@ def make_radar_plot_ext(name, errors, toolname, results, ext):
     plt.savefig(f'plots/ext_{name}.{ext}')
     plt.close('all')
 
+def make_phase_histogram(name, toolname, phases, ext):
+    colors = ['#4D5AAF', '#2ca02c']
+
+    fig, ax = plt.subplots()
+    longest = max(max(phase.get('compile', 0), phase.get('analysis', 0)) for phase in phases)
+    bins = np.linspace(0, longest if longest > 0 else 1, 30)
+    ind = 0
+    for phase in ['compile', 'analysis']:
+        plt.hist([p.get(phase, 0) for p in phases], bins=bins, alpha=0.6, color=colors[ind], label=f"{phase.capitalize()} ({seconds2human(sum(p.get(phase, 0) for p in phases)) or '0'} in total)")
+        ind += 1
+
+    ax.set_title(displayed_name[toolname], weight='bold', size='medium')
+    ax.set_xlabel("Time per test (seconds)")
+    ax.set_ylabel("Number of tests")
+    ax.set_yscale('log')
+    plt.legend()
+    fig.tight_layout()
+
+    plt.savefig(f'plots/{name}.{ext}')
+    plt.close('all')
+
 def make_plot(name, toolnames, ext, black_list=[], merge=False):
     res_type = ["STP", "STN", "CTP", "CFP", "SFN", "SFP", "CE", "RE", "TO", "O", "SE"]
     res = {}
@@ -1584,13 +2080,14 @@ def cmd_plots(rootdir, toolnames, ext="pdf"):
     # Initialize the data structure to gather all results
     results = {'total':{}, 'error':{}}
     timing = {'total':{}, 'error':{}}
+    phases = {toolname: [] for toolname in used_toolnames}
     for error in error_scope:
         results[error] = {}
         timing[error] = {}
         for toolname in used_toolnames:
-            results[error][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
-            results['total'][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
-            results['error'][toolname] = {'failure':[], 'timeout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
+            results[error][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[]}
+            results['total'][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
+            results['error'][toolname] = {'failure':[], 'timeout':[], 'memout':[], 'unimplemented':[], 'other':[], 'TRUE_NEG':[], 'TRUE_POS':[], 'FALSE_NEG':[], 'FALSE_POS':[],'error':[],'OK':[]}
             timing[error][toolname] = []
             timing['total'][toolname] = []
             timing['error'][toolname] = []
@@ -1604,6 +2101,8 @@ def cmd_plots(rootdir, toolnames, ext="pdf"):
         detail=test['detail']
 
         for toolname in used_toolnames:
+            if skipped_repeat(toolname, test_id):
+                continue
             (res_category, elapsed, diagnostic, outcome) = categorize(tool=tools[toolname], toolname=toolname, test_id=test_id, expected=expected)
 
             # if not tools[toolname].is_correct_diagnostic(test_id, res_category, expected, detail):
@@ -1614,6 +2113,9 @@ def cmd_plots(rootdir, toolnames, ext="pdf"):
             results['total'][toolname][res_category].append(test_id)
             timing[error][toolname].append(float(elapsed))
             timing['total'][toolname].append(float(elapsed))
+            phase = read_stats(tools[toolname], toolname, test_id).get('phases')
+            if phase is not None:
+                phases[toolname].append(phase)
             if expected == 'OK':
                 results['total'][toolname]['OK'].append(test_id)
             else:
@@ -1632,6 +2134,12 @@ def cmd_plots(rootdir, toolnames, ext="pdf"):
         make_radar_plot(f'radar_all_{tool}', deter + ndeter, tool, results, ext)
         make_radar_plot_ext(f'radar_all_{tool}', deter + ndeter, tool, results, ext)
 
+    # Histograms of the time spent in each phase
+    for tool in used_toolnames:
+        if len(phases[tool]) > 0:
+            print (f' --- Phase histogram {displayed_name[tool]}')
+            make_phase_histogram(f'phases_{tool}', tool, phases[tool], ext)
+
     # Bar plots with all tools
     make_plot("cat_ext_all", used_toolnames, ext)
     make_plot("cat_ext_all_2", used_toolnames, ext, merge=True)
@@ -1663,7 +2171,11 @@ parser.add_argument('-c', metavar='cmd', default='all',
                     "  latex: Produce the LaTeX tables we need for the article, using the cached values from a previous 'run'.\n"
                     "  run: run the tests on all codes.\n"
                     "  html: produce the HTML statistics, using the cached values from a previous 'run'.\n"
-                    "  plots: produce the plots images, using the cached values from a previous 'run'.\n")
+                    "  plots: produce the plots images, using the cached values from a previous 'run'.\n"
+                    "  import: store the results of a previous 'run' (per-test files of logs/<tool>) into the result store logs/<tool>/results.db, and remove these files.\n"
+                    "  export: write back the per-test files of logs/<tool> from its result store (they are removed once recorded).\n"
+                    "  coordinate: plan the campaigns of the given tools, publish their tests in a queue of logs/<tool>, and show their progress until they are done.\n"
+                    "  worker: run the tests published by the coordinator for the given tool, along with the other workers of that tool.\n")
 
 parser.add_argument('-x', metavar='tool', default='mpirun',
                     help='the tool you want at execution: one among [aislinn, civl, isp, mpisv, must, simgrid, parcoach]')
@@ -1672,7 +2184,47 @@ parser.add_argument('-t', '--timeout', metavar='int', default=300, type=int,
                     help='timeout value at execution time, given in seconds (default: %(default)s)')
 
 parser.add_argument('-b', metavar='batch', default='1/1',
-                    help="Limits the test executions to the batch #N out of M batches (Syntax: 'N/M'). To get 3 runners, use 1/3 2/3 3/3")
+                    help="Limits the test executions to the batch #N out of M batches (Syntax: 'N/M'). To get 3 runners, use 1/3 2/3 3/3. "
+                    "With 'queue', all runners started on the same logs directory pull the tests one at a time from a shared queue.")
+
+parser.add_argument('-j', '--jobs', metavar='int', default=1, type=int,
+                    help="Amount of cores to use when running the tests (default: %(default)s; 0 means all cores). Each test reserves one core per MPI process (-np N). Only used by the tools that can run several tests at once.")
+
+parser.add_argument('--compile-jobs', metavar='int', default=1, type=int,
+                    help="Amount of compile workers building the upcoming tests while the current ones are analyzed, on top of the -j cores (default: %(default)s; 0 compiles each test right before running it)")
+
+parser.add_argument('--no-pch', action='store_true',
+                    help="Do not compile the tests with a precompiled header of their leading #include lines (only used with GCC and Clang based compilers)")
+
+parser.add_argument('--repeat-timing', metavar='K', default=1, type=int,
+                    help="Run each deterministic test K times (the nondeterministic ones are already run 5 times), to report the median, IQR and 95%% confidence interval of their timing (default: %(default)s)")
+
+parser.add_argument('--covering-strength', metavar='t', default=0, type=int,
+                    help="With '-c generate', only generate a t-wise covering subset of the combinations of calls looped over by the generators, in which any t calls of a combination appear together at least once. The skipped combinations are listed in gencodes/covering.json (default: %(default)s, all combinations)")
+
+parser.add_argument('--all-repeats', action='store_true',
+                    help="Run all the repeats of the tests of the nondeterministic categories. By default, the remaining repeats of a test are skipped once the other ones settled its class (such as a CTP, both detected and missed)")
+
+parser.add_argument('--scratch', metavar='dir', default=None,
+                    help="Directory in which each test gets its own scratch directory to be built and run, such as /dev/shm or a size-capped tmpfs mount (default: the temporary directory of the system)")
+
+parser.add_argument('--pin', action='store_true',
+                    help="Pin each running test to its own CPUs (one per MPI process), taken from a single NUMA node when possible. By default, the tests run on any CPU")
+
+parser.add_argument('--order', metavar='order', default='expected', choices=['expected', 'name'],
+                    help="Order in which the tests are run: 'expected' runs first the tests expected to last longer according to the timings of previous runs; 'name' sorts them by file name (default: %(default)s)")
+
+parser.add_argument('--output-cap', metavar='bytes', default=16*1024*1024, type=int,
+                    help="Amount of bytes of the tool output kept in the .txt file of each test (default: %(default)s; 0 means no limit). The middle of larger outputs is only saved in a compressed .txt.gz file, except for the lines matching a verdict of the tool.")
+
+parser.add_argument('--mem-limit', metavar='MiB', default=0, type=float,
+                    help="Memory budget of each MPI process, in MiB (default: %(default)s; 0 means no limit). A test with -np N gets N times that budget, enforced by its own cgroup, and is reported as a memout if it exceeds it.")
+
+parser.add_argument('--cpu-limit', metavar='cores', default=0, type=float,
+                    help="CPU budget of each MPI process, in cores (default: %(default)s; 0 means no limit). A test with -np N is throttled to N times that budget.")
+
+parser.add_argument('--pids-limit', metavar='int', default=0, type=int,
+                    help="Maximal amount of processes and threads per MPI process (default: %(default)s; 0 means no limit). A test with -np N can use N times that amount.")
 
 parser.add_argument('-f', metavar='format', default='pdf',
                     help="Format of output images [pdf, svg, png, ...] (only for 'plots' command)")
@@ -1682,7 +2234,7 @@ rootdir = os.path.dirname(os.path.abspath(__file__))
 
 # Parameter checking: Did we get a valid tool to use?
 arg_tools=[]
-if args.c == 'all' or args.c == 'run':
+if args.c in ['all', 'run', 'coordinate', 'worker']:
     if args.x == 'mpirun':
         raise Exception("No tool was provided, please retry with -x parameter. (see -h for further information on usage)")
     elif args.x in tools:
@@ -1717,6 +2269,18 @@ elif args.c == 'run':
     extract_all_todo(args.b)
     for t in arg_tools:
         cmd_run(rootdir=rootdir, toolname=t, batchinfo=args.b)
+elif args.c == 'coordinate':
+    extract_all_todo('queue')
+    cmd_coordinate(rootdir=rootdir, toolnames=arg_tools)
+elif args.c == 'worker':
+    for t in arg_tools:
+        cmd_run(rootdir=rootdir, toolname=t, batchinfo='worker')
+elif args.c == 'import':
+    for t in arg_tools:
+        cmd_import(rootdir=rootdir, toolname=t)
+elif args.c == 'export':
+    for t in arg_tools:
+        cmd_export(rootdir=rootdir, toolname=t)
 elif args.c == 'latex':
     extract_all_todo(args.b)
     # 'smpi','smpivg' are not shown in the paper
@@ -1744,5 +2308,5 @@ elif args.c == 'plots':
 
     cmd_plots(rootdir, toolnames=toolnames, ext=args.f)
 else:
-    print(f"Invalid command '{args.c}'. Please choose one of 'all', 'generate', 'build', 'run', 'html' 'latex' or 'plots'")
+    print(f"Invalid command '{args.c}'. Please choose one of 'all', 'generate', 'build', 'run', 'import', 'export', 'html' 'latex' or 'plots'")
     sys.exit(1)
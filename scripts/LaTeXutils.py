@@ -3,8 +3,6 @@
 
 from MBIutils import *
 
-possible_features=['P2P!basic', 'P2P!nonblocking', 'P2P!persistent', 'COLL!basic', 'COLL!nonblocking', 'COLL!persistent', 'COLL!tools', 'RMA']
-possible_characterization=["Lacking", "Yes"]
 
 feat_to_color = {'P2P!basic':'viridis0', 'P2P!nonblocking':'viridis1', 'P2P!persistent':'viridis3',
     'RMA':'viridis10',
@@ -13,42 +11,6 @@ feat_to_bgcolor = {'P2P!basic':'white', 'P2P!nonblocking':'white', 'P2P!persiste
     'RMA':'black',
     "COLL!basic":'black', "COLL!nonblocking":'black', "COLL!tools":'black'}
 
-def parse_file_features(file):
-    """Takes a filename and returns a tuple (correct, lacking) of lists of features"""
-    correct = []
-    lacking = []
-    with open(file, 'r') as f:
-        line = f.readline()
-
-        # Search for the feature block
-        while line != 'BEGIN_MPI_FEATURES\n':
-            if line == '':
-                raise Exception("Impossible to find the feature block in {}".format(file))
-            line = f.readline()
-
-        while line != 'END_MPI_FEATURES\n':
-            if line == '':
-                raise Exception("Impossible to find the end of the feature block in {}".format(file))
-
-            line = line.strip()
-            matching = re.match("^ *([!a-zA-Z0-9]*): ([a-zA-Z0-9]*)$", line)
-            if matching is not None:
-                (feat, chara) = (matching.group(1), matching.group(2))
-                if feat not in possible_features:
-                    raise Exception("ERROR: file {} contains an unknown feature: '{}'".format(file, feat))
-                if chara not in possible_characterization:
-                    raise Exception("ERROR: file {} have feature {} with unknown characterization: '{}'".format(file, feat, chara))
-                if chara == 'Yes':
-                    correct.append(feat)
-                elif chara == 'Lacking':
-                    lacking.append(feat)
-                else:
-                    raise Exception("Impossible")
-            line = f.readline()
-    if len(correct) > 4:
-        raise Exception(f"ERROR: file {file} has more than one 4 features: {correct}")
-    return (correct, lacking)
-
 def parse_file_expected(file):
     """Takes a file name, and returns the list of Expect headers (there may be more than one per file)"""
     res  = list(filter(lambda line: line.startswith("  | ERROR: "), open(file, 'r').readlines()))
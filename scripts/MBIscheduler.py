@@ -0,0 +1,494 @@
+# Copyright 2021-2022. The MBI project. All rights reserved.
+# This program is free software; you can redistribute it and/or modify it under the terms of the license (GNU GPL).
+
+# Run the tests of a campaign on several cores at once, without oversubscribing the machine
+
+import os
+import re
+import sys
+import time
+import glob
+import json
+import fcntl
+import socket
+import shutil
+import hashlib
+import tempfile
+import multiprocessing.connection
+
+from MBIutils import possible_details, repeat_group
+from MBIstore import open_store
+
+class CpuPlacement:
+    """
+    Gives disjoint sets of CPUs to the running tests, so that the processes of a test (its MPI ranks, but also the processes of the tool) do not migrate
+    to the CPUs of other tests, nor across NUMA nodes.
+
+    A test gets its CPUs from a single NUMA node when one node has enough free CPUs (the fullest of them, to keep room on the others for larger tests),
+    or from the nodes having the most free CPUs otherwise. Only the CPUs on which we are allowed to run are used (see sched_getaffinity).
+    """
+    def __init__(self, cpus=None, sysfs='/sys/devices/system/node'):
+        allowed = set(os.sched_getaffinity(0) if cpus is None else cpus)
+        self.node_of = {} # CPU -> NUMA node
+        for nodedir in glob.glob(f'{sysfs}/node[0-9]*'):
+            try:
+                with open(f'{nodedir}/cpulist', 'r') as infile:
+                    cpulist = infile.read().strip()
+            except OSError:
+                continue
+            for cpu in parse_cpulist(cpulist):
+                if cpu in allowed:
+                    self.node_of[cpu] = int(re.sub('.*node', '', nodedir))
+        for cpu in allowed: # No NUMA information (or CPUs missing from it): one single node
+            self.node_of.setdefault(cpu, 0)
+        self.free = set(self.node_of)
+
+    def size(self):
+        return len(self.node_of)
+
+    def allocate(self, count):
+        """Reserve that many free CPUs, and returns the placement as a dictionary {'cpus': [...], 'nodes': [...]}. There must be enough free CPUs."""
+        free_per_node = {}
+        for cpu in self.free:
+            free_per_node.setdefault(self.node_of[cpu], []).append(cpu)
+        fitting = [node for node in free_per_node if len(free_per_node[node]) >= count]
+        if len(fitting) > 0:
+            nodes = [min(fitting, key=lambda node: (len(free_per_node[node]), node))]
+        else:
+            nodes = sorted(free_per_node, key=lambda node: (-len(free_per_node[node]), node))
+        cpus = []
+        for node in nodes:
+            cpus += sorted(free_per_node[node])[:count - len(cpus)]
+        if len(cpus) < count:
+            raise Exception(f"Cannot place a test on {count} CPUs: only {len(self.free)} free. Please report that bug.")
+        self.free -= set(cpus)
+        return {'cpus': sorted(cpus), 'nodes': sorted(set(self.node_of[cpu] for cpu in cpus))}
+
+    def release(self, placement):
+        self.free |= set(placement['cpus'])
+
+def parse_cpulist(cpulist):
+    """The CPUs of a list in the format of the Linux kernel (such as '0-3,8-11')"""
+    cpus = []
+    for item in cpulist.split(','):
+        if '-' in item:
+            (first, last) = item.split('-')
+            cpus += range(int(first), int(last) + 1)
+        elif item != '':
+            cpus.append(int(item))
+    return cpus
+
+class Scheduler:
+    """
+    Runs many tests at once, each of them in its own process.
+
+    Every test reserves one core per MPI process (the -np N of its command line), and a test is only started when enough cores are free.
+    Tests are started in the order in which they are provided. A test requesting more cores than available is run alone.
+    The provided tests may contain None items, meaning that no test is available for now but that more may come later (see WorkQueue).
+
+    When a prebuild function is given to run(), the tests are compiled ahead by a pool of compile workers, in addition to the cores running
+    the tests: the build of the upcoming tests overlaps with the (longer) analysis of the running ones, and the tests find their binaries in
+    the build cache. A test is not started while its build is in progress, and the time lost that way is reported as stall time.
+    The tests sharing the same build (see build_key()), such as the repeats of a nondeterministic test, are only built once, and all wait for that build.
+
+    With pinning, each running test gets its own CPUs (see CpuPlacement), given to make_process() along with the test: one CPU per MPI process, even
+    when the test reserves fewer cores (a test larger than the machine still gets all its CPUs, as it runs alone anyway).
+    """
+    def __init__(self, cores, compile_workers=0, pinning=False):
+        self.cores = max(cores, 1)
+        self.used = 0
+        self.running = []  # list of (process, test, reserved cores, placement, deadline)
+        self.placement = None
+        if pinning:
+            self.placement = CpuPlacement()
+            if self.placement.size() < self.cores:
+                print(f"Only {self.placement.size()} CPUs are available to run the tests on {self.cores} cores. Not pinning the tests to their CPUs.")
+                self.placement = None
+        self.compile_workers = compile_workers
+        self.building = [] # list of (process, test, deadline) for the compile workers
+        self.built = set() # build keys of the tests whose build is over
+        self.pipeline = {'prebuilt': 0, 'failed': 0, 'started': 0, 'ready': 0, 'depth': [], 'stall': 0.0}
+
+    def reservation(self, test):
+        """Amount of cores to reserve for that test"""
+        return min(max(test.get('np', 1), 1), self.cores)
+
+    def pinned_cpus(self, test):
+        """Amount of CPUs to pin that test to"""
+        return min(max(test.get('np', 1), 1), self.placement.size())
+
+    def build_key(self, test):
+        """
+        What the build of that test depends on. The wrappers derive the compiler command line from the name of the source file, so the build
+        cache key (see AbstractTool.build_cmd()) is the same for all tests of a given code, and so is the build.
+        """
+        return test['filename']
+
+    def run(self, tests, make_process, hard_timeout, on_done=None, make_prebuild=None, skip=None):
+        """
+        Run all the provided tests.
+
+        Parameters:
+         - tests: an iterable of test descriptions (as returned by parse_one_code()). It is only consumed when there is room to start the next test
+           (or to build it in advance).
+         - make_process: a function returning the (not started) multiprocessing.Process that runs the given test, on the given CPU placement (None without pinning).
+         - hard_timeout: the process of a test is killed if it runs longer than that many seconds.
+         - on_done: a function called with the test description once its process is over.
+         - make_prebuild: a function returning the (not started) multiprocessing.Process that builds the given test in advance, or None to not pipeline the builds.
+         - skip: a function telling whether the given test became useless and should not be started after all (checked right before starting it), or None.
+        """
+        if make_prebuild is None or self.compile_workers <= 0:
+            make_prebuild = None
+            depth = 1
+        else:
+            depth = self.cores + self.compile_workers # Enough upcoming tests to keep all workers busy
+        over = object()
+        tests = iter(tests)
+        upcoming = [] # The next tests to start, in order
+        exhausted = False
+        stall_start = None
+        while not exhausted or len(upcoming) > 0 or len(self.running) > 0:
+            pending = False # Whether the provided tests said that more may come later
+            while not exhausted and len(upcoming) < depth:
+                test = next(tests, over)
+                if test is over:
+                    exhausted = True
+                elif test is None:
+                    pending = True
+                    break
+                else:
+                    upcoming.append(test)
+
+            if make_prebuild is not None:
+                for test in upcoming:
+                    if len(self.building) >= self.compile_workers:
+                        break
+                    if self.build_key(test) not in self.built and not self.is_building(test):
+                        process = make_prebuild(test)
+                        self.start(process)
+                        self.building.append((process, test, time.time() + hard_timeout))
+
+            while len(upcoming) > 0 and self.used + self.reservation(upcoming[0]) <= self.cores:
+                head = upcoming[0]
+                if skip is not None and not self.is_building(head) and skip(head):
+                    upcoming.pop(0)
+                    continue
+                if self.is_building(head): # Its binary will be ready soon
+                    if stall_start is None:
+                        stall_start = time.time()
+                    break
+                if stall_start is not None:
+                    self.pipeline['stall'] += time.time() - stall_start
+                    stall_start = None
+                if make_prebuild is not None:
+                    self.pipeline['started'] += 1
+                    self.pipeline['depth'].append(len([test for test in upcoming if self.build_key(test) in self.built]))
+                    if self.build_key(head) in self.built:
+                        self.pipeline['ready'] += 1
+                placement = self.placement.allocate(self.pinned_cpus(head)) if self.placement is not None else None
+                process = make_process(head, placement)
+                self.start(process)
+                self.used += self.reservation(head)
+                self.running.append((process, head, self.reservation(head), placement, time.time() + hard_timeout))
+                upcoming.pop(0)
+
+            if pending: # Nothing to start for now. Check again a bit later
+                self.wait(on_done, max_delay=5)
+            elif not exhausted or len(upcoming) > 0 or len(self.running) > 0:
+                self.wait(on_done)
+
+    @staticmethod
+    def start(process):
+        sys.stdout.flush() # Don't duplicate our buffered output in the child
+        sys.stderr.flush()
+        process.start()
+
+    def is_building(self, test):
+        return any(self.build_key(building) == self.build_key(test) for (_, building, _) in self.building)
+
+    def pipeline_report(self):
+        """A summary of the build pipeline (None if it was not used): amount of builds done in advance, queue depth (builds ready when a test is started) and stall time."""
+        if self.pipeline['started'] == 0:
+            return None
+        depth = self.pipeline['depth']
+        return (f"Build pipeline: {self.pipeline['prebuilt']} builds done in advance by {self.compile_workers} compile worker{'s' if self.compile_workers > 1 else ''}"
+                + (f" ({self.pipeline['failed']} failed)" if self.pipeline['failed'] > 0 else "")
+                + f"; {self.pipeline['ready']} out of {self.pipeline['started']} tests found their build ready; queue depth {sum(depth)/len(depth):.1f} ready builds on average (max {max(depth)});"
+                + f" the tests waited {self.pipeline['stall']:.1f} seconds for their build.")
+
+    def wait(self, on_done=None, max_delay=None):
+        """Wait until at least one of the running processes or compile workers terminates (or reaches its hard timeout, or max_delay seconds pass), and reclaim its cores."""
+        if len(self.running) == 0 and len(self.building) == 0:
+            if max_delay is not None:
+                time.sleep(max_delay)
+            return
+        delay = max(min([deadline for (_, _, _, _, deadline) in self.running] + [deadline for (_, _, deadline) in self.building]) - time.time(), 0)
+        if max_delay is not None:
+            delay = min(delay, max_delay)
+        multiprocessing.connection.wait([process.sentinel for (process, _, _, _, _) in self.running] + [process.sentinel for (process, _, _) in self.building], timeout=delay)
+
+        still_building = []
+        for (process, test, deadline) in self.building:
+            if process.is_alive() and time.time() > deadline:
+                process.terminate()
+            if process.is_alive():
+                still_building.append((process, test, deadline))
+            else:
+                process.join()
+                self.built.add(self.build_key(test))
+                self.pipeline['prebuilt'] += 1
+                if process.exitcode != 0: # The test will build itself
+                    self.pipeline['failed'] += 1
+        self.building = still_building
+
+        still_running = []
+        for (process, test, cores, placement, deadline) in self.running:
+            if process.is_alive() and time.time() > deadline:
+                print(f"HARD TIMEOUT! The child process running {os.path.basename(test['filename'])} (test {test['id']}) failed to timeout by itself. Sorry for the output.")
+                process.terminate()
+                process.join()
+            if process.is_alive():
+                still_running.append((process, test, cores, placement, deadline))
+            else:
+                process.join()
+                self.used -= cores
+                if placement is not None:
+                    self.placement.release(placement)
+                if on_done is not None:
+                    on_done(test)
+        self.running = still_running
+
+def prebuild_test(tool, execcmd, filename, binary, id, timeout, batchinfo, nprocs=1):
+    """
+    Compile worker of the build pipeline (see Scheduler): build that test into the build cache, unless its result is already cached.
+    The wrapper is run from a private staging directory, so that what it does around the build (removing binaries, moving reports) cannot disturb the tests running in the logs directory.
+    """
+    results_dir = os.getcwd()
+    staging = tempfile.mkdtemp(dir=results_dir, prefix='prebuild-')
+    devnull = os.open(os.devnull, os.O_WRONLY) # The log of the test comes from its execution worker
+    os.dup2(devnull, 1)
+    os.dup2(devnull, 2)
+    tool.prebuild_only = True
+    tool.results_dir = results_dir
+    tool.nprocs = nprocs
+    try:
+        os.chdir(staging)
+        tool.run(execcmd, filename, binary, id, timeout, batchinfo)
+    finally:
+        os.chdir(results_dir)
+        shutil.rmtree(staging, ignore_errors=True)
+
+class RuntimeModel:
+    """
+    Predicts the duration of the tests of a tool, from the results of previous runs (in its result store, or in the .elapsed and .timeout files of its logs directory).
+
+    A test that already ran is expected to last as long as last time (or at least the timeout if it timeouted).
+    Other tests are expected to last as long as the average of the tests of the same generator family and error category,
+    or of the same family, or of the same error category, or of all tests, whichever is the first to have some history.
+    """
+    def __init__(self, tests, test_id, timeout):
+        self.test_id = test_id
+        self.history = {}
+        samples = {}
+        for test in tests:
+            duration = self.read_duration(test_id(test), timeout)
+            if duration is None:
+                continue
+            self.history[test_id(test)] = duration
+            for key in self.keys(test):
+                samples.setdefault(key, []).append(duration)
+        self.averages = {key: sum(values)/len(values) for (key, values) in samples.items()}
+
+    @staticmethod
+    def read_duration(test_id, timeout):
+        if os.path.exists(f'{test_id}.elapsed'):
+            with open(f'{test_id}.elapsed', 'r') as infile:
+                elapsed = infile.read()
+            timeouted = os.path.exists(f'{test_id}.timeout')
+        else: # Only kept in the result store
+            store = open_store('results.db')
+            stored = store.get(test_id) if store is not None else None
+            if stored is None or stored[1] is None:
+                return None
+            (elapsed, timeouted) = (stored[1], stored[0] == 'timeout')
+        try:
+            duration = float(elapsed)
+        except ValueError:
+            return None
+        if timeouted:
+            duration = max(duration, timeout)
+        return duration
+
+    @staticmethod
+    def keys(test):
+        """The groups of tests used to predict the duration of that test, from the most to the least specific"""
+        category = possible_details[test['detail']]
+        return [(test['generator'], category), (test['generator'], None), (None, category), (None, None)]
+
+    def predict(self, test):
+        if self.test_id(test) in self.history:
+            return self.history[self.test_id(test)]
+        for key in self.keys(test):
+            if key in self.averages:
+                return self.averages[key]
+        return 0
+
+    def sort(self, tests):
+        """
+        Sort the tests in place, longest-expected-first (LPT scheduling). Tests with the same prediction keep their order.
+        The repeats of a nondeterministic test are kept together (as long as the longest of them), so that they run at the same time.
+        """
+        groups = {}
+        for test in tests:
+            if repeat_group(test) is not None:
+                groups[repeat_group(test)] = max(groups.get(repeat_group(test), 0), self.predict(test))
+        tests.sort(key=lambda test: -groups[repeat_group(test)] if repeat_group(test) is not None else -self.predict(test))
+
+class WorkQueue:
+    """
+    A queue of tests shared by all the runners of a given tool, on the same machine or on a shared volume.
+
+    Each runner pulls the tests one at a time, so that the campaign ends when the total amount of work is done, whatever the duration of each test.
+    A pulled test is leased to its runner for a limited time. If the runner crashes before reporting the test as done, the lease expires and the test is pulled again by another runner.
+
+    The queue is stored in the given directory: 'queue.todo' lists all test ids (in order), 'queue.state' holds the index of the next test to pull and the current leases,
+    and 'queue.lock' is used to serialize the accesses of all runners. The queue files are removed once all tests are done.
+    When the queue is created by a coordinator (see MBI.py, cmd_coordinate()), 'queue.jobs' also describes each test, so that the workers can run them without parsing the codes.
+    """
+    def __init__(self, directory, lease):
+        self.todo_file = f'{directory}/queue.todo'
+        self.state_file = f'{directory}/queue.state'
+        self.lock_file = f'{directory}/queue.lock'
+        self.jobs_file = f'{directory}/queue.jobs'
+        self.lease = lease
+        self.owner = f'{socket.gethostname()}:{os.getpid()}'
+        self.items = []
+        self.jobs = {}
+
+    def __enter__(self):
+        self.lock = open(self.lock_file, 'a')
+        fcntl.flock(self.lock, fcntl.LOCK_EX)
+        return self
+
+    def __exit__(self, *exc):
+        fcntl.flock(self.lock, fcntl.LOCK_UN)
+        self.lock.close()
+
+    def load_state(self):
+        with open(self.state_file, 'r') as infile:
+            return json.load(infile)
+
+    def save_state(self, state):
+        with open(f'{self.state_file}.tmp', 'w') as outfile:
+            json.dump(state, outfile)
+        os.replace(f'{self.state_file}.tmp', self.state_file)
+
+    def read_items(self):
+        with open(self.todo_file, 'r') as infile:
+            return [test_id for test_id in infile.read().split('\n') if test_id != '']
+
+    def join(self, test_ids, jobs=None):
+        """Join the campaign in progress, or start a new one with the given test ids if there is none (or if the previous one was abandoned with other tests). The jobs, if any, describe each test for the workers."""
+        digest = hashlib.md5('\n'.join(test_ids).encode()).hexdigest()
+        with self:
+            if os.path.exists(self.state_file) and os.path.exists(self.todo_file):
+                state = self.load_state()
+                active = [owner for (owner, expires) in state['leases'].values() if expires > time.time()]
+                if state['digest'] == digest or len(active) > 0:
+                    if state['digest'] != digest:
+                        print(f"WARNING: joining a queue of {self.todo_file} that was created with other tests (still leased by {', '.join(sorted(set(active)))}).")
+                    self.items = self.read_items()
+                    print(f"Joining the queue of {len(self.items)} tests in progress ({state['next']} already pulled).")
+                    return
+            self.items = test_ids
+            if jobs is not None: # Written first, so that the workers never see a queue without its jobs
+                with open(f'{self.jobs_file}.tmp', 'w') as outfile:
+                    json.dump(jobs, outfile)
+                os.replace(f'{self.jobs_file}.tmp', self.jobs_file)
+            elif os.path.exists(self.jobs_file):
+                os.remove(self.jobs_file)
+            with open(self.todo_file, 'w') as outfile:
+                outfile.write('\n'.join(test_ids))
+            self.save_state({'digest': digest, 'next': 0, 'leases': {}})
+            print(f"Created a queue of {len(self.items)} tests.")
+
+    def pull(self):
+        """Lease the next available test. Returns its id, None if all remaining tests are leased to alive runners, or False if all tests are done."""
+        with self:
+            if not os.path.exists(self.state_file):
+                return False # Someone else noticed that everything is done
+            state = self.load_state()
+            now = time.time()
+            # Reclaim the tests of crashed runners first
+            for (test_id, (owner, expires)) in sorted(state['leases'].items(), key=lambda lease: lease[1][1]):
+                if expires < now:
+                    print(f"Reclaiming test {test_id}, whose lease by {owner} expired {int(now - expires)} seconds ago.")
+                    state['leases'][test_id] = (self.owner, now + self.lease)
+                    self.save_state(state)
+                    return test_id
+            if state['next'] < len(self.items):
+                test_id = self.items[state['next']]
+                state['next'] += 1
+                state['leases'][test_id] = (self.owner, now + self.lease)
+                self.save_state(state)
+                return test_id
+            if len(state['leases']) > 0:
+                return None
+            for filename in [self.state_file, self.todo_file, self.jobs_file]:
+                if os.path.exists(filename):
+                    os.remove(filename)
+            return False
+
+    def done(self, test_id):
+        """Release the lease of that test, that is now done. A lease that expired and was given to another runner is left to that runner."""
+        with self:
+            if not os.path.exists(self.state_file):
+                return
+            state = self.load_state()
+            if test_id in state['leases'] and state['leases'][test_id][0] == self.owner:
+                del state['leases'][test_id]
+                self.save_state(state)
+
+    def attach(self, wait):
+        """Attach to the queue created by a coordinator, waiting up to that amount of seconds for it to appear. Returns whether there is such a queue."""
+        deadline = time.time() + wait
+        while True:
+            with self:
+                if os.path.exists(self.state_file) and os.path.exists(self.todo_file) and os.path.exists(self.jobs_file):
+                    self.items = self.read_items()
+                    with open(self.jobs_file, 'r') as infile:
+                        self.jobs = json.load(infile)
+                    print(f"Attached to the queue of {len(self.items)} tests of the coordinator ({self.load_state()['next']} already pulled).")
+                    return True
+            if time.time() >= deadline:
+                return False
+            time.sleep(2)
+
+    def progress(self):
+        """The progress of the campaign, as a dictionary (total amount of tests, pulled ones, running ones and their runners), or None if there is no queue (anymore)."""
+        with self:
+            if not os.path.exists(self.state_file) or not os.path.exists(self.todo_file):
+                return None
+            state = self.load_state()
+            total = len(self.read_items())
+        return {'total': total, 'pulled': state['next'], 'running': len(state['leases']),
+                'runners': set(owner for (owner, expires) in state['leases'].values() if expires > time.time())}
+
+    def tests(self, todo, test_id):
+        """Join the queue with the given tests, and yield them as they get pulled from the queue (or None when the remaining ones are leased by others)"""
+        self.join([test_id(test) for test in todo])
+        return self.pulled({test_id(test): test for test in todo})
+
+    def pulled(self, by_id):
+        """Yield the tests of that dictionary {test_id: test} as they get pulled from the queue (or None when the remaining ones are leased by others)"""
+        while True:
+            pulled = self.pull()
+            if pulled is False:
+                return
+            if pulled is None:
+                yield None
+            elif pulled in by_id:
+                yield by_id[pulled]
+            else:
+                print(f"WARNING: test {pulled} from the queue is not known by this runner. Skipping it.")
+                self.done(pulled)
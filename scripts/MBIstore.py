@@ -0,0 +1,350 @@
+# Copyright 2021-2022. The MBI project. All rights reserved.
+# This program is free software; you can redistribute it and/or modify it under the terms of the license (GNU GPL).
+
+# Keep all results of a tool in a single file, instead of several tiny files per test
+
+import os
+import sys
+import time
+import json
+import zlib
+import fcntl
+import socket
+import hashlib
+import inspect
+import tempfile
+
+try:
+    import sqlite3
+except ImportError: # Some docker images come with a python built without sqlite. Results are then only kept in the per-test files.
+    sqlite3 = None
+
+# The per-test files that are kept in the store, as produced by AbstractTool.run_cmd() and by some wrappers
+stored_extensions = ['txt', 'elapsed', 'md5sum', 'cachekey', 'timeout', 'memout', 'stats', 'html']
+
+class ResultStore:
+    """
+    The results of all tests of a given tool, stored in a SQLite database (logs/{tool}/results.db).
+
+    Each entry holds the outcome computed by the tool parser, the elapsed time, the cache key and the per-test files
+    (compressed), so that the reports can be computed without opening thousands of files, and that archiving the logs
+    only needs that database. The per-test files written by a test are removed once they are recorded, and can be
+    exported back from the store on need (see restore() and export_tree()).
+    """
+    def __init__(self, filename):
+        self.filename = filename
+        self.db = sqlite3.connect(filename, timeout=120)
+        self.db.execute("CREATE TABLE IF NOT EXISTS results (test_id TEXT PRIMARY KEY, outcome TEXT, elapsed TEXT, cachekey TEXT, parser TEXT, files BLOB, stats TEXT)")
+        if 'stats' not in [column[1] for column in self.db.execute("PRAGMA table_info(results)")]: # Store created by an older MBI
+            self.db.execute("ALTER TABLE results ADD COLUMN stats TEXT")
+        self.db.commit()
+
+    @staticmethod
+    def available():
+        return sqlite3 is not None
+
+    def get(self, test_id):
+        """Returns the (outcome, elapsed, cachekey, parser) stored for that test, or None."""
+        return self.db.execute("SELECT outcome, elapsed, cachekey, parser FROM results WHERE test_id=?", (test_id,)).fetchone()
+
+    def test_ids(self):
+        return [row[0] for row in self.db.execute("SELECT test_id FROM results ORDER BY test_id")]
+
+    def record(self, tool, test_id, directory='.', discard=False):
+        """
+        Parse the files of that test (in the given directory) with the tool, and store them along with the outcome. Tests that are already stored with the same timing and cache key are not parsed again.
+        With discard, the per-test files are removed once they are stored.
+        """
+        files = {}
+        for ext in stored_extensions:
+            if os.path.isfile(f'{directory}/{test_id}.{ext}'):
+                with open(f'{directory}/{test_id}.{ext}', 'r', errors='replace') as infile:
+                    files[ext] = infile.read()
+        if 'txt' not in files or 'elapsed' not in files: # The test did not run (or only its output was written back from the store, see MBI.py, cmd_html())
+            return False
+        stored = self.get(test_id)
+        parser = parser_digest(tool)
+        if stored is not None and stored[1] == files.get('elapsed') and stored[2] == files.get('cachekey', files.get('md5sum')) and stored[3] == parser:
+            if discard:
+                discard_files(test_id, directory)
+            return False
+
+        here = os.getcwd()
+        os.chdir(directory)
+        try:
+            outcome = parse_outcome(tool, test_id)
+        finally:
+            os.chdir(here)
+        self.db.execute("INSERT OR REPLACE INTO results (test_id, outcome, elapsed, cachekey, parser, files, stats) VALUES (?, ?, ?, ?, ?, ?, ?)",
+                        (test_id, outcome, files.get('elapsed'), files.get('cachekey', files.get('md5sum')), parser, zlib.compress(json.dumps(files).encode()), files.get('stats')))
+        self.db.commit()
+        if discard:
+            discard_files(test_id, directory)
+        return True
+
+    def reparse(self, tool, test_id, directory='.'):
+        """Parse again the stored files of that test, after a change of the tool wrapper. They are written back in the given directory (the logs directory of the tool, where the parser may find other things such as report directories) for the time of the parsing."""
+        self.restore(test_id, directory)
+        self.record(tool, test_id, directory, discard=True)
+
+    def get_stats(self, test_id):
+        """Returns the content of the .stats file of that test, or None."""
+        row = self.db.execute("SELECT stats FROM results WHERE test_id=?", (test_id,)).fetchone()
+        return row[0] if row is not None else None
+
+    def forget(self, test_id):
+        self.db.execute("DELETE FROM results WHERE test_id=?", (test_id,))
+        self.db.commit()
+
+    def restore(self, test_id, directory='.', extensions=None):
+        """Write back the per-test files of that test in the given directory (only the ones with the given extensions if any)."""
+        row = self.db.execute("SELECT files FROM results WHERE test_id=?", (test_id,)).fetchone()
+        if row is None:
+            return
+        for (ext, content) in json.loads(zlib.decompress(row[0]).decode()).items():
+            if extensions is not None and ext not in extensions:
+                continue
+            with open(f'{directory}/{test_id}.{ext}', 'w') as outfile:
+                outfile.write(content)
+
+    def import_tree(self, tool, directory):
+        """Record all the results found in a log directory of the former layout (one set of files per test), and remove their per-test files."""
+        count = 0
+        for filename in sorted(os.listdir(directory)):
+            if filename.endswith('.elapsed') and self.record(tool, filename[:-len('.elapsed')], directory, discard=True):
+                count += 1
+        return count
+
+    def export_tree(self, directory):
+        """Write back the per-test files of all stored results in the given directory."""
+        test_ids = self.test_ids()
+        for test_id in test_ids:
+            self.restore(test_id, directory)
+        return len(test_ids)
+
+def discard_files(test_id, directory='.'):
+    """Remove the per-test files of that test, once they are kept in the result store."""
+    for ext in stored_extensions:
+        if os.path.exists(f'{directory}/{test_id}.{ext}'):
+            os.remove(f'{directory}/{test_id}.{ext}')
+
+opened_stores = {}
+def open_store(filename):
+    """The result store kept in that file, opened once per process, or None if there is no such store (or no sqlite)."""
+    if not ResultStore.available() or not os.path.exists(filename):
+        return None
+    key = (os.getpid(), os.path.abspath(filename)) # A connection must not be used by the forked test processes, and the runs of several tools open their stores by relative names
+    if key not in opened_stores:
+        opened_stores[key] = ResultStore(filename)
+    return opened_stores[key]
+
+def store_of(toolname):
+    """The result store of that tool, from the root directory or from the logs directory of the tool, or None."""
+    if os.path.exists(f'logs/{toolname}/results.db'):
+        return open_store(f'logs/{toolname}/results.db')
+    return open_store('results.db')
+
+def recorded_key(test_id, directory='.'):
+    """The cache key of the result of that test (see AbstractTool.cache_key()), from its .cachekey file or from the result store of the given directory, or None."""
+    if os.path.exists(f'{directory}/{test_id}.cachekey'):
+        with open(f'{directory}/{test_id}.cachekey', 'r') as infile:
+            content = infile.read()
+    else:
+        store = open_store(f'{directory}/results.db')
+        stored = store.get(test_id) if store is not None else None
+        if stored is None or stored[2] is None:
+            return None
+        content = stored[2]
+    try:
+        key = json.loads(content)
+    except ValueError:
+        return None
+    return key if type(key) is dict else None # Results of older MBI versions only have an md5sum
+
+def has_result(test_id, directory='.'):
+    """Whether that test has a result, in its per-test files or in the result store of the given directory."""
+    if os.path.exists(f'{directory}/{test_id}.txt'):
+        return True
+    store = open_store(f'{directory}/results.db')
+    return store is not None and store.get(test_id) is not None
+
+parser_digests = {}
+def parser_digest(tool):
+    """The md5sum of the source of that tool wrapper, so that the stored outcomes get parsed again when the wrapper changes."""
+    if type(tool) not in parser_digests:
+        try:
+            with open(inspect.getsourcefile(type(tool)), 'rb') as infile:
+                parser_digests[type(tool)] = hashlib.md5(infile.read()).hexdigest()
+        except (OSError, TypeError):
+            parser_digests[type(tool)] = None
+    return parser_digests[type(tool)]
+
+def parse_outcome(tool, test_id):
+    """The outcome of that test (from its logs directory): 'memout' if it exceeded its memory budget (the tool parsers know nothing about it), or what the tool parser makes of its output."""
+    if os.path.exists(f'{test_id}.memout'):
+        return 'memout'
+    return tool.parse(test_id)
+
+class RunJournal:
+    """
+    Write-ahead journal of the campaigns of a tool (logs/{tool}/journal), so that an interrupted campaign can be resumed.
+
+    Each line is a JSON event appended by the test workers: 'start' right before a test runs, and 'done' once its result is recorded,
+    along with what that result depends on (the cache key, and the identity of the source file, wrapper and command line).
+    A test whose last event is a 'start' of a runner that is gone was interrupted, and its files may be half-written (see MBI.py, cmd_run()).
+    Each runner holds a lease (a locked file of {journal}.leases) recorded in its 'start' events: a runner is gone once nobody holds its lease anymore,
+    which still holds after a restart of its container (with another hostname) and when its pid is reused.
+    The appends are serialized with a lock file, so that several runners can share the same journal.
+    """
+    def __init__(self, filename='journal'):
+        self.filename = filename
+
+    def locked(self):
+        lockfile = open(f'{self.filename}.lock', 'w')
+        fcntl.flock(lockfile, fcntl.LOCK_EX)
+        return lockfile # Unlocked when closed
+
+    def append(self, event):
+        with self.locked():
+            fd = os.open(self.filename, os.O_WRONLY | os.O_APPEND | os.O_CREAT, 0o644)
+            try:
+                os.write(fd, (json.dumps(event, sort_keys=True) + '\n').encode())
+                os.fsync(fd)
+            finally:
+                os.close(fd)
+
+    def lease(self):
+        """The name of the lease of this runner, created on need. It is locked until this process and the test processes it forked are all over."""
+        journal = os.path.abspath(self.filename) # Each journal (of each tool) gets its own lease
+        if journal not in held_leases:
+            os.makedirs(f'{self.filename}.leases', exist_ok=True)
+            (fd, tmpname) = tempfile.mkstemp(dir=f'{self.filename}.leases', suffix='.tmp')
+            lockfile = os.fdopen(fd, 'w')
+            fcntl.flock(lockfile, fcntl.LOCK_EX)
+            lockfile.write(f'{socket.gethostname()} {os.getpid()}\n')
+            lockfile.flush()
+            name = os.path.basename(tmpname)[:-len('.tmp')] + '.lease'
+            os.rename(tmpname, f'{self.filename}.leases/{name}') # Only visible once locked, so that expire_leases() cannot remove it in between
+            held_leases[journal] = (name, lockfile)
+        return held_leases[journal][0]
+
+    def held(self, lease):
+        """Whether some live runner holds that lease"""
+        try:
+            with open(f'{self.filename}.leases/{lease}', 'r') as lockfile:
+                try:
+                    fcntl.flock(lockfile, fcntl.LOCK_EX | fcntl.LOCK_NB)
+                except BlockingIOError:
+                    return True
+                return False
+        except FileNotFoundError:
+            return False
+
+    def expire_leases(self):
+        """Remove the leases of the runners that are gone"""
+        if not os.path.isdir(f'{self.filename}.leases'):
+            return
+        for lease in os.listdir(f'{self.filename}.leases'):
+            if lease.endswith('.lease') and not self.held(lease):
+                try:
+                    os.remove(f'{self.filename}.leases/{lease}')
+                except FileNotFoundError: # Removed by another runner
+                    pass
+
+    def started(self, test_id):
+        self.append({'event': 'start', 'test': test_id, 'lease': self.lease(), 'host': socket.gethostname(), 'pid': os.getpid(), 'time': time.time()})
+
+    def finished(self, test_id, filename, execcmd, tool):
+        event = {'event': 'done', 'test': test_id, 'time': time.time(), 'filename': filename, 'cmd': execcmd, 'wrapper': parser_digest(tool), 'cachekey': None}
+        stat = os.stat(filename)
+        event['source'] = [stat.st_size, stat.st_mtime_ns]
+        event['cachekey'] = recorded_key(test_id) # None if we can't tell what that result depends on, so that it will be checked again
+        self.append(event)
+
+    def replay(self):
+        """The last event of each test, as a dictionary {test_id: event}. A line truncated by a crash is ignored."""
+        res = {}
+        if os.path.exists(self.filename):
+            with open(self.filename, 'r') as infile:
+                for line in infile:
+                    try:
+                        event = json.loads(line)
+                    except ValueError:
+                        continue
+                    res[event['test']] = event
+        return res
+
+    def compact(self, forget=[]):
+        """Rewrite the journal with only the last event of each test, and without the given tests."""
+        with self.locked():
+            events = self.replay()
+            with open(f'{self.filename}.tmp', 'w') as outfile:
+                for (test_id, event) in sorted(events.items()):
+                    if test_id not in forget:
+                        outfile.write(json.dumps(event, sort_keys=True) + '\n')
+            os.rename(f'{self.filename}.tmp', self.filename)
+
+    def interrupted(self, event):
+        """Whether that event is the start of a test whose runner is gone before the test was done."""
+        if event['event'] != 'start':
+            return False
+        if 'lease' in event:
+            return not self.held(event['lease'])
+        if event.get('host') != socket.gethostname(): # Journal of an older MBI, without leases: only the processes of this host can be checked
+            return False
+        try:
+            os.kill(event['pid'], 0)
+        except ProcessLookupError:
+            return True
+        except OSError:
+            pass
+        return False
+
+held_leases = {} # absolute path of a journal -> (name, locked file) of the lease of this runner, inherited by the test processes it forks
+
+def run_and_record(tool, execcmd, filename, binary, id, timeout, batchinfo, nprocs=1, placement=None, seed=None):
+    """Run that test with the tool (from its logs directory), and record its result in the store of the tool and in the run journal."""
+    tool.nprocs = nprocs # To compute the resource budget of the test
+    if placement is not None: # The build, the tool and the MPI ranks inherit the CPUs given to that test by the scheduler (see CpuPlacement)
+        os.sched_setaffinity(0, placement['cpus'])
+        tool.placement = placement
+    if seed is not None: # A repeat of a nondeterministic test
+        os.environ['MBI_SEED'] = str(seed)
+        tool.seed = seed
+    if os.path.exists(f'{binary}_{id}.skipped'): # This repeat was skipped by a previous campaign, but is run this time
+        os.remove(f'{binary}_{id}.skipped')
+    journal = RunJournal()
+    journal.started(f'{binary}_{id}')
+    tool.run(execcmd, filename, binary, id, timeout, batchinfo)
+    if ResultStore.available():
+        try:
+            ResultStore('results.db').record(tool, f'{binary}_{id}', discard=True)
+        except Exception as e: # The per-test files are still here, so that's not fatal
+            print(f"Cannot record the result of {binary}_{id} in the store: {e}", file=sys.stderr)
+    journal.finished(f'{binary}_{id}', filename, execcmd, tool)
+
+def stored_result(tool, toolname, test_id):
+    """
+    Returns the (outcome, elapsed) stored for that test (from the root directory or from the logs directory of the tool), or None if it is not stored.
+    If the wrapper changed since the test was recorded, its stored files are parsed again.
+    """
+    store = store_of(toolname)
+    stored = store.get(test_id) if store is not None else None
+    if stored is None:
+        return None
+    if stored[3] != parser_digest(tool):
+        store.reparse(tool, test_id, os.path.dirname(store.filename) or '.')
+        stored = store.get(test_id)
+    return (stored[0], stored[1])
+
+def stored_stats(tool, toolname, test_id):
+    """Returns the content of the .stats file of that test stored (from the root directory), or None."""
+    if stored_result(tool, toolname, test_id) is None:
+        return None
+    return store_of(toolname).get_stats(test_id)
+
+def forget_result(toolname, test_id):
+    """Remove that test from the store (if any), so that it is run again."""
+    store = store_of(toolname)
+    if store is not None:
+        store.forget(test_id)
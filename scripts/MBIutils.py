@@ -2,16 +2,70 @@
 # This program is free software; you can redistribute it and/or modify it under the terms of the license (GNU GPL).
 
 import os
+import errno
 import time
 import subprocess
 import sys
 import re
 import shlex
-import select
+import ctypes
+import resource
 import signal
+import selectors
+import json
+import gzip
+import math
+import collections
+import shutil
 import hashlib
+import tempfile
+import runpy
+import inspect
+
+from MBIstore import *
 
 class AbstractTool:
+    # Whether several tests can be run concurrently with this tool on the same machine (see the -j option of MBI.py).
+    # Wrappers compiling or running in a shared directory, or killing processes by name, must leave this to False.
+    parallel_safe = False
+
+    # Regular expressions matching the lines of the tool output on which parse() bases its verdict.
+    # When the output of a test is too large (see output_cap), these lines are kept in the .txt file even if they are in the truncated part.
+    verdicts = ['MBI_MSG_RACE', 'Compilation of .*? raised an error']
+
+    # Regular expressions matching the lines after which the verdict of the tool cannot change anymore.
+    # The tool is stopped as soon as one of them is seen in its output, instead of letting it run until its end (or its timeout).
+    final_verdicts = []
+
+    # Amount of bytes of the tool output kept in the .txt file of each test (set from the --output-cap option of MBI.py).
+    # Larger outputs are truncated in the middle, and fully saved in a compressed .txt.gz file.
+    output_cap = 16*1024*1024
+
+    # Resource budget of each MPI process (set from the --mem-limit, --cpu-limit and --pids-limit options of MBI.py), 0 meaning unlimited.
+    # Each test gets nprocs times that budget, enforced by its own cgroup (see TestCgroup). Exceeding the memory budget gives the 'memout' outcome.
+    mem_limit = 0  # MiB
+    cpu_limit = 0  # cores
+    pids_limit = 0 # processes
+    nprocs = 1     # Amount of MPI processes of the test being run (set by run_and_record())
+
+    # The CPUs (and their NUMA nodes) to which the test being run is pinned, recorded in its .stats file (set by run_and_record(), None without pinning).
+    placement = None
+
+    # The scheduling seed of the repeat of a nondeterministic test being run, exported to the build and the tool as MBI_SEED and recorded in its .stats file (set by run_and_record(), None for the other tests).
+    # Wrappers of tools that can randomize their scheduling should use it.
+    seed = None
+
+    # Whether the tests are compiled with a precompiled header of their #include lines (see pch_flags() and the --no-pch option of MBI.py).
+    use_pch = True
+
+    # Directory in which the per-test scratch directories are created (set from the --scratch option of MBI.py), None for the default temporary directory.
+    # Pointing it to a RAM-backed file system (tmpfs, /dev/shm) keeps the binaries and temporaries of the tools off the disk.
+    scratch_root = None
+
+    # Set in the compile workers of the build pipeline (see prebuild_test()): run_cmd() then only fills the build cache, for the tests whose result in results_dir is not cached.
+    prebuild_only = False
+    results_dir = '.'
+
     def ensure_image(self, params="", dockerparams=""):
         """Verify that this is executed from the right docker image, and complain if not."""
         if os.path.exists("/MBI") or os.path.exists("trust_the_installation"):
@@ -25,6 +79,10 @@ class AbstractTool:
     def set_rootdir(self, rootdir):
         self.rootdir = rootdir
 
+    def identify(self):
+        """Returns a string identifying this tool (and its version, if possible). Changing it invalidates all the cached results of the tool."""
+        return type(self).__name__
+
     def build(self, rootdir, cached=True):
         """Rebuilds the tool binaries. By default, we try to reuse the existing build."""
         print ("Nothing to do to rebuild the tool binaries.")
@@ -47,7 +105,10 @@ class AbstractTool:
         """
         Runs the test on need. Returns True if the test was ran, and False if it was cached. This method SHOULD NOT be overloaded, change things in run()
 
-        The result is cached if possible, and the test is rerun only if the `test.txt` (containing the tool output) or the `test.elapsed` (containing the timing info) do not exist, or if `test.md5sum` (containing the md5sum of the code to compile) does not match.
+        The result is cached if possible, and the test is rerun only if the `test.txt` (containing the tool output) or the `test.elapsed` (containing the timing info) do not exist, or if `test.cachekey` does not match.
+        Once recorded in the result store, these files are removed (see run_and_record()), and the result is cached as long as the cache key stored along with it matches.
+        That cache key (see cache_key()) covers the code to compile, the tool identity and binaries, the build and exec command lines and the timeout.
+        Results of older MBI versions, that only have a `test.md5sum` (containing the md5sum of the code to compile), are reused if that md5sum still matches.
 
         Parameters:
          - buildcmd and execcmd are shell commands to run. buildcmd can be any shell line (incuding && groups), but execcmd must be a single binary to run.
@@ -56,41 +117,50 @@ class AbstractTool:
          - binary the file name in which to compile the code
          - batchinfo: something like "1/1" to say that this run is the only batch (see -b parameter of MBI.py)
          - cwd: directory in which the command must be run (or None if it's not to be changed from current working directory)
-         - read_line_lambda: a lambda to which each line of the tool output is feed ASAP. It allows MUST to interrupt the execution when a deadlock is reported.
+         - read_line_lambda: a lambda to which each line of the tool output is feed ASAP. To stop the tool once its verdict is known, better declare its final_verdicts.
         """
 
-        if os.path.exists(f'{cachefile}.txt') and os.path.exists(f'{cachefile}.elapsed') and os.path.exists(f'{cachefile}.md5sum'):
-            hash_md5 = hashlib.md5()
-            with open(filename, 'rb') as sourcefile :
-                for chunk in iter(lambda: sourcefile.read(4096), b""):
-                    hash_md5.update(chunk)
-            newdigest = hash_md5.hexdigest()
-            with open(f'{cachefile}.md5sum', 'r') as md5file:
-                olddigest = md5file.read()
-            #print(f'Old digest: {olddigest}; New digest: {newdigest}')
-            if olddigest == newdigest:
-                print(f" (result cached -- digest: {olddigest})")
-                return False
-            os.remove(f'{cachefile}.txt')
+        key = self.cache_key(buildcmd, execcmd, filename, timeout, cwd)
+        if self.prebuild_only:
+            if buildcmd is not None and not self.cached(key, f'{self.results_dir}/{cachefile}'):
+                self.setup()
+                self.build_cmd(buildcmd, filename, cache_only=True)
+            return False
+        if self.cached(key, cachefile):
+            return False
+        previous = self.complete_duration(cachefile) # To estimate the time saved by an early verdict
+        for ext in ['txt', 'txt.gz', 'timeout', 'memout', 'stats']:
+            if os.path.exists(f'{cachefile}.{ext}'):
+                os.remove(f'{cachefile}.{ext}')
 
         self.setup()
+        key['binaries'] = self.tool_binaries(buildcmd, execcmd)
 
         print(f"Wait up to {timeout} seconds")
 
         start_time = time.time()
+        stats = {} if self.placement is None else {'placement': self.placement}
+        if self.seed is not None:
+            stats['seed'] = self.seed
         if buildcmd is None:
             output = f"No need to compile {binary}.c (batchinfo:{batchinfo})\n\n"
         else:
             output = f"Compiling {binary}.c (batchinfo:{batchinfo})\n\n"
             output += f"$ {buildcmd}\n"
 
-            compil = subprocess.run(buildcmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-            if compil.stdout is not None:
-                output += str(compil.stdout, errors='replace')
-            if compil.returncode != 0:
-                output += f"Compilation of {binary}.c raised an error (retcode: {compil.returncode})"
+            (returncode, stdout, cached, build) = self.build_cmd(buildcmd, filename)
+            # The compiler wrappers of the tools compile and link in a single invocation, so both are accounted in the compile phase.
+            # A cached build took no time for that test, so the actual build (maybe done by a compile worker) is recorded apart
+            stats['phases'] = {'compile': time.time() - start_time, 'compile_cached': cached, 'compile_pch': build is not None and build['pch']}
+            if build is not None:
+                stats['phases'].update({'build': build['time'], 'build_entry': build['entry']})
+            output += str(stdout, errors='replace')
+            if returncode != 0:
+                output += f"Compilation of {binary}.c raised an error (retcode: {returncode})"
                 for line in (output.split('\n')):
                     print(f"| {line}", file=sys.stderr)
+                with open(f'{cachefile}.stats', 'w') as outfile:
+                    json.dump(stats, outfile, indent=1, sort_keys=True)
                 with open(f'{cachefile}.elapsed', 'w') as outfile:
                     outfile.write(str(time.time() - start_time))
                 with open(f'{cachefile}.txt', 'w') as outfile:
@@ -100,53 +170,50 @@ class AbstractTool:
         output += f"\n\nExecuting the command (cwd: {cwd})\n $ {execcmd}\n"
         for line in (output.split('\n')):
             print(f"| {line}", file=sys.stderr)
+        output = OutputCapture(output, self.output_cap, self.verdicts, f'{cachefile}.txt.gz')
 
-        # We run the subprocess and parse its output line by line, so that we can kill it as soon as it detects a timeout
-        process = subprocess.Popen(shlex.split(execcmd), cwd=cwd, stdout=subprocess.PIPE,
-                                   stderr=subprocess.STDOUT, preexec_fn=os.setsid)
-        poll_obj = select.poll()
-        poll_obj.register(process.stdout, select.POLLIN)
-
-        pid = process.pid
-        pgid = os.getpgid(pid)  # We need that to forcefully kill subprocesses when leaving
+        # We run the subprocess and parse its output as it comes, so that we can kill it as soon as it detects a timeout or prints a final verdict
+        usage_before = resource.getrusage(resource.RUSAGE_CHILDREN)
+        cgroup = TestCgroup(cachefile, key['limits']) if key['limits'] is not None else None
+        analysis_start = time.time()
+        supervisor = Supervisor(execcmd, cwd, deadline=start_time + timeout, cgroup=cgroup)
         outcome = None
+        final_verdict = re.compile('|'.join(f'(?:{pattern})' for pattern in self.final_verdicts)) if len(self.final_verdicts) > 0 else None
         while True:
-            if poll_obj.poll(5):  # Something to read? Do check the timeout status every 5 sec if not
-                line = process.stdout.readline()
-                # From byte array to string, replacing non-representable strings with question marks
-                line = str(line, errors='replace')
-                output = output + line
-                print(f"| {line}", end='', file=sys.stderr)
+            (event, chunk) = supervisor.wait()
+            for line in output.feed(chunk):
                 if read_line_lambda != None:
-                    read_line_lambda(line, process)
-            if time.time() - start_time > timeout:
+                    read_line_lambda(line, supervisor.process)
+                if final_verdict is not None and 'early_stop' not in stats and final_verdict.search(line):
+                    # The verdict is known. Stop the tool and everything it forked, and grab the rest of its output as usual
+                    stats['early_stop'] = {'verdict': line.strip(), 'time': time.time() - start_time}
+                    output.write(f"\nMBI: stopping the tool after its final verdict: {line.strip()}\n")
+                    supervisor.signal(signal.SIGTERM)
+            if event == 'timeout':
                 outcome = 'timeout'
                 with open(f'{cachefile}.timeout', 'w') as outfile:
                     outfile.write(f'{time.time() - start_time} seconds')
                 break
-            if process.poll() is not None:  # The subprocess ended. Grab all existing output, and return
-                line = 'more'
-                while line != None and line != '':
-                    line = process.stdout.readline()
-                    if line is not None:
-                        # From byte array to string, replacing non-representable strings with question marks
-                        line = str(line, errors='replace')
-                        output = output + line
-                        print(f"| {line}", end='', file=sys.stderr)
-
+            if event == 'exit':
                 break
+        analysis_end = time.time()
+        output.feed(b'', final=True)
 
         # We want to clean all forked processes in all cases, no matter whether they are still running (timeout) or supposed to be off. The runners easily get clogged with zombies :(
-        try:
-            os.killpg(pgid, signal.SIGTERM)  # Terminate all forked processes, to make sure it's clean whatever the tool does
-            process.terminate()  # No op if it's already stopped but useful on timeouts
-            time.sleep(0.2)  # allow some time for the tool to finish its childs
-            os.killpg(pgid, signal.SIGKILL)  # Finish 'em all, manually
-            os.kill(pid, signal.SIGKILL)  # die! die! die!
-        except ProcessLookupError:
-            pass  # OK, it's gone now
+        supervisor.cleanup()
+        process = supervisor.process
+        if cgroup is not None:
+            stats['cgroup'] = cgroup.close()
+            if stats['cgroup']['oom_kills'] > 0:
+                outcome = 'memout'
+                with open(f'{cachefile}.memout', 'w') as outfile:
+                    outfile.write(f"{stats['cgroup']['oom_kills']} process(es) killed for exceeding the memory budget of {key['limits']['memory']} bytes")
+                output.write(f"\nMBI: the tool exceeded its memory budget of {key['limits']['memory'] // (1024*1024)} MiB, and was killed.\n")
+        # All descendants of the tool are reaped now, so their resource usage was accumulated to ours
+        stats['resources'] = resource_usage(usage_before, resource.getrusage(resource.RUSAGE_CHILDREN), supervisor.usage)
 
         elapsed = time.time() - start_time
+        stats.setdefault('phases', {}).update({'analysis': analysis_end - analysis_start, 'cleanup': start_time + elapsed - analysis_end})
 
         rc = process.poll()
         if rc < 0:
@@ -154,22 +221,301 @@ class AbstractTool:
         else:
             status = f"Command return code: {rc}, elapsed time: {elapsed}\n"
         print(status)
-        output += status
+        output.write(status)
+        if 'early_stop' in stats:
+            # Only an estimate (not a measure, so not in the phases): how long the tool would have run after its verdict, according to its last complete run, or at most until the timeout
+            (basis, duration) = ('previous complete run', previous) if previous is not None else ('timeout', timeout)
+            stats['early_stop']['saved_estimate'] = {'seconds': max(duration - stats['early_stop']['time'], 0), 'basis': basis}
+        if len(stats) > 0:
+            with open(f'{cachefile}.stats', 'w') as outfile:
+                json.dump(stats, outfile, indent=1, sort_keys=True)
 
         with open(f'{cachefile}.elapsed', 'w') as outfile:
             outfile.write(str(elapsed))
 
         with open(f'{cachefile}.txt', 'w') as outfile:
-            outfile.write(output)
+            output.save(outfile)
         with open(f'{cachefile}.md5sum', 'w') as outfile:
-            hashed = hashlib.md5()
-            with open(filename, 'rb') as sourcefile :
-                for chunk in iter(lambda: sourcefile.read(4096), b""):
-                    hashed.update(chunk)
-            outfile.write(hashed.hexdigest())
+            outfile.write(key['source'])
+        with open(f'{cachefile}.cachekey', 'w') as outfile:
+            json.dump(key, outfile, indent=1, sort_keys=True)
+
+        return True
 
+    def complete_duration(self, cachefile):
+        """The elapsed time of the last run of that test (in its files, or in the result store next to them), if the tool ran to its end: not stopped on a timeout, a memout nor an early verdict. None otherwise."""
+        if os.path.exists(f'{cachefile}.elapsed'):
+            with open(f'{cachefile}.elapsed', 'r') as infile:
+                elapsed = infile.read()
+            stats = {}
+            if os.path.exists(f'{cachefile}.stats'):
+                with open(f'{cachefile}.stats', 'r') as infile:
+                    try:
+                        stats = json.load(infile)
+                    except ValueError:
+                        pass
+            interrupted = os.path.exists(f'{cachefile}.timeout') or os.path.exists(f'{cachefile}.memout')
+        else:
+            store = open_store(f'{os.path.dirname(cachefile) or "."}/results.db')
+            stored = store.get(os.path.basename(cachefile)) if store is not None else None
+            if stored is None or stored[1] is None:
+                return None
+            elapsed = stored[1]
+            try:
+                stats = json.loads(store.get_stats(os.path.basename(cachefile)) or '{}')
+            except ValueError:
+                stats = {}
+            interrupted = stored[0] in ['timeout', 'memout']
+        if interrupted or 'early_stop' in stats:
+            return None
+        try:
+            return float(elapsed)
+        except ValueError:
+            return None
+
+    def cached(self, key, cachefile):
+        """Whether the result of that test (in the files named after cachefile, or in the result store next to them) is cached and still valid for that cache key (see run_cmd())."""
+        oldkey = None
+        if os.path.exists(f'{cachefile}.txt') and os.path.exists(f'{cachefile}.elapsed') and os.path.exists(f'{cachefile}.cachekey'):
+            oldkey = recorded_key(os.path.basename(cachefile), os.path.dirname(cachefile) or '.') or {}
+        elif not (os.path.exists(f'{cachefile}.txt') and os.path.exists(f'{cachefile}.elapsed') and os.path.exists(f'{cachefile}.md5sum')):
+            # Only kept in the result store, or partly written back from it (such as the outputs linked by the HTML report)
+            oldkey = recorded_key(os.path.basename(cachefile), os.path.dirname(cachefile) or '.')
+        if oldkey is not None:
+            changed = [field for field in key if field != 'binaries' and oldkey.get(field) != key[field]]
+            # The tool binaries are only known once the tool is setup. Check that the ones used to compute the cached result did not change.
+            changed += [f'binary {path}' for (path, digest) in oldkey.get('binaries', {}).items() if binary_digest(path, self.rootdir) != digest]
+            if len(changed) == 0:
+                print(f" (result cached -- digest: {key['source']})")
+                return True
+            print(f" (cached result invalidated: {', '.join(changed)} changed)")
+        elif os.path.exists(f'{cachefile}.txt') and os.path.exists(f'{cachefile}.elapsed') and os.path.exists(f'{cachefile}.md5sum'):
+            with open(f'{cachefile}.md5sum', 'r') as md5file:
+                olddigest = md5file.read()
+            if olddigest == key['source']:
+                # A result from an older MBI, that did not record its cache key. Trust it, and record the current key.
+                with open(f'{cachefile}.cachekey', 'w') as outfile:
+                    json.dump(key, outfile, indent=1, sort_keys=True)
+                print(f" (result cached -- digest: {olddigest})")
+                return True
+        return False
+
+    def journaled(self, event, filename, execcmd, timeout, nprocs):
+        """
+        Whether the result of a test is complete and still valid according to its last event in the run journal (see RunJournal), checked without hashing its source:
+        the source file (same size and date), the wrapper, the command line, the tool identity, the timeout, the resource limits and the tool binaries must be unchanged.
+        """
+        key = event.get('cachekey')
+        if event['event'] != 'done' or key is None or event.get('filename') != filename or event.get('cmd') != execcmd or event.get('wrapper') != parser_digest(self):
+            return False
+        try:
+            stat = os.stat(filename)
+        except OSError:
+            return False
+        if event.get('source') != [stat.st_size, stat.st_mtime_ns] or not has_result(event['test']):
+            return False
+        (saved, self.nprocs) = (self.nprocs, nprocs)
+        limits = self.limits()
+        self.nprocs = saved
+        if key.get('tool') != self.identify() or key.get('timeout') != timeout or key.get('limits') != limits:
+            return False
+        for (path, digest) in key.get('binaries', {}).items():
+            if path not in journaled_digests:
+                journaled_digests[path] = binary_digest(path, self.rootdir)
+            if journaled_digests[path] != digest:
+                return False
         return True
 
+    def scratch_dir(self):
+        """
+        A new directory (to use in a 'with' statement) where the wrappers build and run a test, removed with everything the tool left there at the end of the block.
+        Only what parse() and the reports need should be copied from there to the logs directory.
+        """
+        return tempfile.TemporaryDirectory(dir=self.scratch_root)
+
+    def cache_key(self, buildcmd, execcmd, filename, timeout, cwd):
+        """
+        Computes what the result of a test depends on, as a dictionary: the md5sum of the source, the tool identity, the build and exec command lines, the timeout and the resource limits.
+        The temporary directories in which the wrappers build and run the tests are replaced by a placeholder in the command lines.
+        The digests of the tool binaries are added by run_cmd() once the tool is setup (see tool_binaries()).
+        """
+        hashed = hashlib.md5()
+        with open(filename, 'rb') as sourcefile :
+            for chunk in iter(lambda: sourcefile.read(4096), b""):
+                hashed.update(chunk)
+        def normalize(cmd):
+            if cmd is None:
+                return None
+            if cwd is not None:
+                cmd = cmd.replace(cwd, '${CWD}')
+            return re.sub(f'{re.escape(tempfile.gettempdir())}/tmp[a-z0-9_]{{8}}', '${TMPDIR}', cmd)
+        return {'source': hashed.hexdigest(), 'tool': self.identify(), 'build': normalize(buildcmd), 'exec': normalize(execcmd), 'timeout': timeout, 'limits': self.limits()}
+
+    def limits(self):
+        """The resource budget of the current test (proportional to its amount of MPI processes) as a dictionary {'memory': bytes, 'cpu': cores, 'pids': processes}, or None if unlimited."""
+        if self.mem_limit <= 0 and self.cpu_limit <= 0 and self.pids_limit <= 0:
+            return None
+        nprocs = max(self.nprocs, 1)
+        return {'memory': int(self.mem_limit * nprocs * 1024 * 1024) if self.mem_limit > 0 else None,
+                'cpu': self.cpu_limit * nprocs if self.cpu_limit > 0 else None,
+                'pids': int(self.pids_limit * nprocs) if self.pids_limit > 0 else None}
+
+    def tool_binaries(self, buildcmd, execcmd):
+        """Returns the digests of the programs invoked by the build and exec command lines (found in the PATH), as a dictionary {realpath: digest}."""
+        res = {}
+        for cmd in [buildcmd, execcmd]:
+            for step in re.split('&&|[;|]', cmd or ''):
+                words = step.split()
+                if len(words) == 0 or (not os.path.isabs(words[0]) and '/' in words[0]): # The compiled test itself
+                    continue
+                path = shutil.which(words[0])
+                if path is not None:
+                    path = os.path.realpath(path)
+                    res[path] = binary_digest(path, self.rootdir)
+        return res
+
+    def build_cmd(self, buildcmd, filename, cache_only=False):
+        """
+        Runs the given build command, or reuse the result of an identical build from the cache. Returns the return code and the output of the build, whether it came from the cache,
+        and the actual build as a dictionary {'time': seconds, 'pch': whether it used a precompiled header (see pch_flags()), 'entry': its cache entry}, or None if unknown.
+        The actual build of a cached result is the one recorded in its cache entry: it was maybe done by a compile worker of the build pipeline (see prebuild_test()), or for another test.
+
+        The build cache (in {rootdir}/cache/build) is shared by all tests and all tools: the 5 tests of a given code, or smpi and simgrid compiling the same code
+        with the same compiler, only build it once. The cache is keyed by the content of the source, the compiler command line (with the output file name
+        left aside) and the version of the compiler. Only builds made of a single compiler invocation with a '-o' output file are cached; other commands are simply run.
+        With cache_only, the build is only done if it can be cached and is not yet, and its output file is not produced (see prebuild_test()).
+        """
+        argv = shlex.split(buildcmd) if re.search('[;&|<>`$]', buildcmd) is None else []
+        if '-o' not in argv or argv.index('-o') + 1 >= len(argv) or getattr(self, 'rootdir', None) is None:
+            if cache_only:
+                return (None, b'', False, None)
+            start_time = time.time()
+            compil = subprocess.run(buildcmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            return (compil.returncode, compil.stdout or b'', False, {'time': time.time() - start_time, 'pch': False, 'entry': None})
+        target = argv[argv.index('-o') + 1]
+        compiler = shutil.which(argv[0])
+        if compiler is None: # Let the shell complain
+            if cache_only:
+                return (None, b'', False, None)
+            start_time = time.time()
+            compil = subprocess.run(buildcmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            return (compil.returncode, compil.stdout or b'', False, {'time': time.time() - start_time, 'pch': False, 'entry': None})
+
+        key = hashlib.sha256()
+        with open(filename, 'rb') as sourcefile:
+            for chunk in iter(lambda: sourcefile.read(4096), b""):
+                key.update(chunk)
+        key.update('\0'.join([os.path.realpath(compiler)] + [arg if arg != target else '-o-target-' for arg in argv[1:]]).encode())
+        key.update(compiler_version(compiler))
+        entry = f'{self.rootdir}/cache/build/{key.hexdigest()}'
+
+        if not os.path.exists(f'{entry}/retcode'):
+            start_time = time.time()
+            pch = self.pch_flags(argv, target, filename, compiler) if self.use_pch else None
+            if pch is not None:
+                compil = subprocess.run(' '.join(shlex.quote(arg) for arg in argv[:1] + pch['flags'] + argv[1:]), shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+                if compil.returncode != 0: # Maybe because of the precompiled header. Build as requested to get the genuine output
+                    pch_output = compil.stdout or b''
+                    compil = subprocess.run(buildcmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+                    if compil.returncode == 0: # The precompiled header is to blame (not the code, that many tests get wrong on purpose). Don't use it anymore
+                        with open(f"{pch['entry']}/broken", 'wb') as outfile:
+                            outfile.write(pch_output)
+                    pch = None
+            else:
+                compil = subprocess.run(buildcmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            build = {'time': time.time() - start_time, 'pch': pch is not None, 'entry': os.path.basename(entry)}
+            if compil.returncode == 0 and not os.path.isfile(target):
+                return (compil.returncode, compil.stdout or b'', False, dict(build, entry=None)) # Weird compiler. Don't try to cache that
+            # Fill a temporary entry, and atomically rename it into the cache. If another process built the same code at the same time, keep its entry.
+            os.makedirs(f'{self.rootdir}/cache/build', exist_ok=True)
+            tmpentry = tempfile.mkdtemp(dir=f'{self.rootdir}/cache/build', prefix='tmp-')
+            with open(f'{tmpentry}/output', 'wb') as outfile:
+                outfile.write(compil.stdout or b'')
+            if compil.returncode == 0:
+                shutil.copy2(target, f'{tmpentry}/artifact')
+            with open(f'{tmpentry}/build.json', 'w') as outfile:
+                json.dump(build, outfile)
+            with open(f'{tmpentry}/retcode', 'w') as outfile:
+                outfile.write(str(compil.returncode))
+            try:
+                os.rename(tmpentry, entry)
+            except OSError:
+                shutil.rmtree(tmpentry, ignore_errors=True)
+            return (compil.returncode, compil.stdout or b'', False, build)
+
+        if cache_only:
+            return (None, b'', True, None)
+        print(f"(build cached in {entry})", file=sys.stderr)
+        with open(f'{entry}/retcode', 'r') as infile:
+            returncode = int(infile.read())
+        with open(f'{entry}/output', 'rb') as infile:
+            stdout = infile.read()
+        try:
+            with open(f'{entry}/build.json', 'r') as infile:
+                build = json.load(infile)
+        except (OSError, ValueError): # Entry of an older MBI
+            build = None
+        if returncode == 0:
+            if os.path.lexists(target):
+                os.remove(target)
+            try:
+                os.link(f'{entry}/artifact', target)
+            except OSError: # Not on the same file system
+                shutil.copy2(f'{entry}/artifact', target)
+        return (returncode, stdout, True, build)
+
+    def pch_flags(self, argv, target, filename, compiler):
+        """
+        Returns the flags to add to that compiler command line to use a precompiled header, as a dictionary {'flags': [...], 'entry': cache directory}, or None if that's not possible.
+
+        Most generated codes start with the same #include lines (mpi.h, stdio.h, ...). They are precompiled once per compiler, compiler flags and list of headers,
+        in {rootdir}/cache/pch, and force-included (-include) before the code. The code including the same headers again afterward is harmless thanks to their
+        include guards, so the result is the same as without the precompiled header. Only GCC and Clang (and the wrappers based on them) are supported.
+        """
+        includes = leading_includes(filename)
+        version = compiler_version(compiler).decode(errors='replace').lower()
+        if 'clang' in version:
+            extension = 'pch'
+        elif 'gcc' in version or 'free software foundation' in version:
+            extension = 'gch'
+        else:
+            return None
+        if len(includes) == 0:
+            return None
+        # The precompiled header must be built with the same flags as the code, but without its input and output files and without linking
+        flags = []
+        skip = False
+        for arg in argv[1:]:
+            if skip:
+                skip = False
+            elif arg == '-o':
+                skip = True
+            elif arg in ['-c', '-S', '-E', '-emit-llvm'] or arg == filename or arg == target or re.match('-[lL]|-Wl,', arg) or re.search(r'\.(c|cc|cpp|cxx|o|a|so|bc|ll)$', arg):
+                pass
+            else:
+                flags.append(arg)
+        key = hashlib.sha256('\0'.join([os.path.realpath(compiler)] + flags + includes).encode())
+        key.update(compiler_version(compiler))
+        entry = f'{self.rootdir}/cache/pch/{key.hexdigest()}'
+
+        if not os.path.exists(f'{entry}/prologue.h'):
+            os.makedirs(f'{self.rootdir}/cache/pch', exist_ok=True)
+            tmpentry = tempfile.mkdtemp(dir=f'{self.rootdir}/cache/pch', prefix='tmp-')
+            with open(f'{tmpentry}/prologue.h', 'w') as outfile:
+                outfile.write('\n'.join(includes) + '\n')
+            # Built in the temporary entry, but for the final location: the precompiled header records the path of its source
+            precompile = subprocess.run([argv[0]] + flags + ['-c', '-x', 'c-header', f'{tmpentry}/prologue.h', '-o', f'{tmpentry}/prologue.h.{extension}'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            if precompile.returncode != 0 or not os.path.exists(f'{tmpentry}/prologue.h.{extension}'):
+                with open(f'{tmpentry}/broken', 'wb') as outfile:
+                    outfile.write(precompile.stdout or b'')
+            try:
+                os.rename(tmpentry, entry)
+            except OSError: # Another process did it at the same time
+                shutil.rmtree(tmpentry, ignore_errors=True)
+        if os.path.exists(f'{entry}/broken'):
+            return None
+        return {'flags': ['-include', f'{entry}/prologue.h'], 'entry': entry}
+
     def teardown(self):
         """
         Clean the results of all test runs: remove temp files and binaries.
@@ -188,6 +534,576 @@ class AbstractTool:
         """
         return True
 
+class Supervisor:
+    """
+    Runs a tool command in its own session, and watches its output and its termination until a given deadline.
+
+    The output and the termination of the tool are waited for at once (using a pidfd when both the kernel and python support it),
+    so that the tool is neither polled nor left running after its deadline. The calling process is made a child subreaper, so that
+    the descendants of the tool that escape its process group (such as daemonized MPI launchers) are reparented to it. cleanup()
+    can then kill and reap exactly the descendants of this tool, without disturbing the tests running concurrently on the same host.
+    """
+    def __init__(self, cmd, cwd, deadline, cgroup=None):
+        become_subreaper()
+        self.previous_children = set(child_processes())
+        def preexec():
+            os.setsid()
+            if cgroup is not None: # Enter the cgroup before exec, so that the tool and all its descendants are confined from the start
+                cgroup.attach()
+        self.process = subprocess.Popen(shlex.split(cmd), cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, preexec_fn=preexec)
+        self.pgid = self.process.pid  # The tool leads its own session and process group, thanks to setsid
+        self.deadline = deadline
+        self.stdout = self.process.stdout.fileno()
+        self.selector = selectors.DefaultSelector()
+        self.selector.register(self.stdout, selectors.EVENT_READ)
+        self.usage = None # The resources used by the tool process (and the descendants it waited for), once it is reaped
+        self.pidfd = None
+        if hasattr(os, 'pidfd_open'): # python 3.9 and above
+            try:
+                self.pidfd = os.pidfd_open(self.process.pid)
+                self.selector.register(self.pidfd, selectors.EVENT_READ)
+            except OSError: # Linux before 5.3
+                self.pidfd = None
+
+    def wait(self):
+        """
+        Wait for something to happen. Returns ('output', chunk) when the tool wrote something, ('exit', remaining output) when it terminated,
+        or ('timeout', b'') when the deadline is reached.
+        """
+        while True:
+            if self.poll() is not None:
+                return ('exit', self.drain())
+            remaining = self.deadline - time.time()
+            if remaining <= 0:
+                return ('timeout', b'')
+            # Without pidfd, the termination of the tool is not always visible on its output (which can be kept open by its descendants)
+            for (key, _) in self.selector.select(remaining if self.pidfd is not None else min(remaining, 0.5)):
+                if key.fd == self.stdout:
+                    chunk = os.read(self.stdout, 1024*1024)
+                    if chunk != b'':
+                        return ('output', chunk)
+                    self.selector.unregister(self.stdout) # The output is closed. Only wait for the termination now
+
+    def drain(self):
+        """Read what remains in the output pipe, without waiting for the descendants that may keep it open"""
+        chunks = []
+        while self.stdout in self.selector.get_map() and time.time() < self.deadline and any(key.fd == self.stdout for (key, _) in self.selector.select(0.1)):
+            chunk = os.read(self.stdout, 1024*1024)
+            if chunk == b'':
+                self.selector.unregister(self.stdout)
+            chunks.append(chunk)
+        return b''.join(chunks)
+
+    def signal(self, signum):
+        """Send that signal to all processes of the tool's group."""
+        try:
+            os.killpg(self.pgid, signum)
+        except ProcessLookupError:
+            pass  # Ok, it's gone now
+
+    def poll(self):
+        """Like Popen.poll(), but reap the tool with wait4() to get its resource usage."""
+        if self.process.returncode is None:
+            try:
+                (pid, status, usage) = os.wait4(self.process.pid, os.WNOHANG)
+            except ChildProcessError: # Already reaped
+                return self.process.poll()
+            if pid != 0:
+                self.usage = usage
+                self.process.returncode = -os.WTERMSIG(status) if os.WIFSIGNALED(status) else os.WEXITSTATUS(status)
+        return self.process.returncode
+
+    def group_alive(self):
+        self.poll()
+        self.reap()
+        try:
+            os.killpg(self.pgid, 0)
+            return True
+        except ProcessLookupError:
+            return False
+
+    def orphans(self):
+        """The descendants of the tool that got reparented to us"""
+        return [pid for pid in child_processes() if pid != self.process.pid and pid not in self.previous_children]
+
+    def reap(self):
+        for pid in self.orphans():
+            try:
+                os.waitpid(pid, os.WNOHANG)
+            except ChildProcessError:
+                pass
+
+    def cleanup(self, grace=0.2):
+        """Terminate the process group of the tool, let it `grace` seconds to terminate, kill what remains, and reap everything."""
+        self.signal(signal.SIGTERM)
+        end = time.time() + grace
+        while time.time() < end and self.group_alive():
+            time.sleep(0.01)
+        self.signal(signal.SIGKILL)
+        while self.poll() is None:
+            time.sleep(0.01)
+        # The descendants that left the tool's group were reparented to us when their parents died
+        for _ in range(10):
+            orphans = self.orphans()
+            if len(orphans) == 0:
+                break
+            for pid in orphans:
+                try:
+                    os.kill(pid, signal.SIGKILL)
+                    os.waitpid(pid, 0)
+                except (ProcessLookupError, ChildProcessError):
+                    pass
+        self.selector.close()
+        self.process.stdout.close()
+        if self.pidfd is not None:
+            os.close(self.pidfd)
+
+cgroup_tests_dir = None # Where the cgroups of the tests are created (see setup_cgroups())
+
+def setup_cgroups(controllers):
+    """
+    Prepare the cgroup (v2) under which each test gets its own cgroup with its resource budget (see TestCgroup). Raises an Exception if that's not possible.
+    This must be called before forking the test workers. Controllers can only be delegated by a cgroup containing no process, so the processes of our
+    current cgroup (typically, all processes of the docker container) are first moved to a leaf cgroup, as done by the container runtimes.
+    """
+    global cgroup_tests_dir
+    try:
+        with open('/proc/self/cgroup', 'r') as infile:
+            path = [line[3:].strip() for line in infile if line.startswith('0::')][0]
+    except (OSError, IndexError):
+        raise Exception("Cannot enforce the resource limits: cgroup v2 is not available on this machine.")
+    mountpoint = '/sys/fs/cgroup'
+    try:
+        with open('/proc/self/mountinfo', 'r') as infile:
+            for line in infile: # The cgroup2 hierarchy is in /sys/fs/cgroup/unified on the hosts in hybrid mode
+                (fields, fstype) = (line.split(' - ')[0].split(), line.split(' - ')[1].split()[0])
+                if fstype == 'cgroup2':
+                    mountpoint = fields[4]
+    except (OSError, IndexError):
+        pass
+    base = mountpoint + path.rstrip('/')
+    if not os.path.exists(f'{base}/cgroup.controllers'):
+        raise Exception(f"Cannot enforce the resource limits: {base} is not a cgroup v2 (is /sys/fs/cgroup mounted read-write? Use 'docker run --cgroupns=private' or a delegated cgroup).")
+    with open(f'{base}/cgroup.controllers', 'r') as infile:
+        missing = [controller for controller in controllers if controller not in infile.read().split()]
+    if len(missing) > 0:
+        raise Exception(f"Cannot enforce the resource limits: the {', '.join(missing)} controller(s) are not delegated to {base}.")
+
+    def delegate(cgroup):
+        with open(f'{cgroup}/cgroup.subtree_control', 'w') as outfile:
+            outfile.write(' '.join(f'+{controller}' for controller in controllers))
+    try:
+        try:
+            delegate(base)
+        except OSError as e:
+            if e.errno != errno.EBUSY:
+                raise
+            os.makedirs(f'{base}/mbi-init', exist_ok=True)
+            with open(f'{base}/cgroup.procs', 'r') as infile:
+                pids = infile.read().split()
+            for pid in pids:
+                try:
+                    with open(f'{base}/mbi-init/cgroup.procs', 'w') as outfile:
+                        outfile.write(pid)
+                except OSError: # That process is gone already, or is a kernel thread
+                    pass
+            delegate(base)
+        os.makedirs(f'{base}/mbi-tests', exist_ok=True)
+        delegate(f'{base}/mbi-tests')
+    except OSError as e:
+        raise Exception(f"Cannot enforce the resource limits: cannot delegate the controllers of {base} ({e}).")
+    cgroup_tests_dir = f'{base}/mbi-tests'
+
+class TestCgroup:
+    """
+    The cgroup (v2) confining a test run to its resource budget (see AbstractTool.limits()): memory.max without swap, cpu.max and pids.max.
+    When the test exceeds its memory, the kernel kills all its processes at once (memory.oom.group), and close() reports it in its 'oom_kills' accounting.
+    """
+    def __init__(self, name, limits):
+        self.path = f'{cgroup_tests_dir}/{name}-{os.getpid()}'
+        os.makedirs(self.path, exist_ok=True)
+        if limits['memory'] is not None:
+            self.write('memory.max', limits['memory'])
+            self.write('memory.swap.max', 0, optional=True)
+            self.write('memory.oom.group', 1, optional=True)
+        if limits['cpu'] is not None:
+            self.write('cpu.max', f"{int(limits['cpu'] * 100000)} 100000")
+        if limits['pids'] is not None:
+            self.write('pids.max', limits['pids'])
+
+    def write(self, filename, value, optional=False):
+        if optional and not os.path.exists(f'{self.path}/{filename}'):
+            return
+        with open(f'{self.path}/{filename}', 'w') as outfile:
+            outfile.write(str(value))
+
+    def read(self, filename):
+        """Returns the content of a flat keyed file (such as memory.events) as a dictionary, or the value of a single-value file (such as memory.peak). None if the file does not exist."""
+        try:
+            with open(f'{self.path}/{filename}', 'r') as infile:
+                lines = infile.read().split('\n')
+        except OSError:
+            return None
+        if len(lines[0].split()) == 1:
+            return int(lines[0]) if lines[0].isdigit() else lines[0]
+        return {line.split()[0]: int(line.split()[1]) for line in lines if len(line.split()) == 2}
+
+    def attach(self):
+        """Move the calling process into that cgroup"""
+        self.write('cgroup.procs', os.getpid())
+
+    def close(self):
+        """Kill what remains in the cgroup, remove it, and return its accounting: OOM kills, peak memory, CPU time, CPU throttling and hits of the pids budget."""
+        memory_events = self.read('memory.events') or {}
+        cpu_stat = self.read('cpu.stat') or {}
+        pids_events = self.read('pids.events') or {}
+        res = {'oom_kills': memory_events.get('oom_kill', 0), 'memory_peak': self.read('memory.peak'),
+               'cpu_usec': cpu_stat.get('usage_usec'), 'throttled_usec': cpu_stat.get('throttled_usec'), 'pids_max_hits': pids_events.get('max', 0)}
+
+        if os.path.exists(f'{self.path}/cgroup.kill'): # Linux 5.14 and above
+            self.write('cgroup.kill', 1)
+        else:
+            try:
+                with open(f'{self.path}/cgroup.procs', 'r') as infile:
+                    pids = infile.read().split()
+            except OSError:
+                pids = []
+            for pid in pids:
+                try:
+                    os.kill(int(pid), signal.SIGKILL)
+                except ProcessLookupError:
+                    pass
+        end = time.time() + 2
+        while time.time() < end and (self.read('cgroup.events') or {}).get('populated', 0) != 0:
+            for pid in child_processes(): # The killed processes reparented to us must be reaped before the cgroup becomes empty
+                try:
+                    os.waitpid(pid, os.WNOHANG)
+                except ChildProcessError:
+                    pass
+            time.sleep(0.01)
+        try:
+            os.rmdir(self.path)
+        except OSError as e:
+            print(f"Cannot remove the cgroup {self.path}: {e}", file=sys.stderr)
+        return res
+
+def set_alternative(name, path):
+    """Select that alternative (see update-alternatives), unless it is already selected. This avoids concurrent tests fighting over the alternatives database."""
+    try:
+        if os.readlink(f'/etc/alternatives/{name}') == path:
+            return
+    except OSError:
+        pass
+    subprocess.run(f"update-alternatives --set {name} {path}", shell=True, check=True)
+
+def resource_usage(before, after, tool=None):
+    """
+    The resources used by the children reaped between these two getrusage(RUSAGE_CHILDREN) calls: CPU time in seconds, peak memory in KiB, page faults, I/O in bytes and context switches.
+    The peak memory is the one of the largest process, not of the whole process tree. It is taken from the rusage of the tool process when given (as returned by wait4),
+    since the maximum over all children may come from the compiler. Otherwise, it is None if no process was larger than the ones reaped before.
+    """
+    if tool is not None:
+        max_rss = tool.ru_maxrss
+    else:
+        max_rss = after.ru_maxrss if after.ru_maxrss > before.ru_maxrss else None
+    return {'cpu_user': after.ru_utime - before.ru_utime, 'cpu_sys': after.ru_stime - before.ru_stime,
+            'max_rss': max_rss,
+            'major_faults': after.ru_majflt - before.ru_majflt, 'minor_faults': after.ru_minflt - before.ru_minflt,
+            'read_bytes': (after.ru_inblock - before.ru_inblock) * 512, 'written_bytes': (after.ru_oublock - before.ru_oublock) * 512,
+            'voluntary_switches': after.ru_nvcsw - before.ru_nvcsw, 'involuntary_switches': after.ru_nivcsw - before.ru_nivcsw}
+
+def summarize_resources(usages):
+    """Aggregate the resource usages of several tests (as returned by resource_usage()): total and mean CPU time, largest and mean peak memory (in MiB), and total faults, I/O and switches."""
+    res = {'tests': len(usages), 'cpu': 0, 'mean_cpu': None, 'max_rss': None, 'mean_rss': None, 'major_faults': 0, 'read_bytes': 0, 'written_bytes': 0, 'switches': 0}
+    rss = [usage['max_rss'] / 1024 for usage in usages if usage.get('max_rss') is not None]
+    for usage in usages:
+        res['cpu'] += usage['cpu_user'] + usage['cpu_sys']
+        res['major_faults'] += usage['major_faults']
+        res['read_bytes'] += usage['read_bytes']
+        res['written_bytes'] += usage['written_bytes']
+        res['switches'] += usage['voluntary_switches'] + usage['involuntary_switches']
+    if len(usages) > 0:
+        res['mean_cpu'] = res['cpu'] / len(usages)
+    if len(rss) > 0:
+        res['max_rss'] = max(rss)
+        res['mean_rss'] = sum(rss) / len(rss)
+    return res
+
+def summarize_phases(phases):
+    """
+    Aggregate the phase timings of several tests (as recorded by run_cmd()): total and mean time spent to compile the tests and to analyze them, amount of builds found in the build cache,
+    and total and mean time of the actual builds (counting once the builds shared by several tests, and the ones done by the compile workers) with and without precompiled header.
+    """
+    res = {'tests': len(phases), 'compile': 0, 'analysis': 0, 'cleanup': 0, 'mean_compile': None, 'mean_analysis': None, 'compile_cached': 0, 'build': 0, 'mean_compile_pch': None, 'mean_compile_nopch': None}
+    builds = {True: {}, False: {}} # build entry -> duration
+    for (num, phase) in enumerate(phases):
+        for name in ['compile', 'analysis', 'cleanup']:
+            res[name] += phase.get(name, 0)
+        if phase.get('compile_cached', False):
+            res['compile_cached'] += 1
+        if 'build' in phase:
+            builds[phase.get('compile_pch', False)][phase.get('build_entry') or num] = phase['build']
+        elif 'compile' in phase and not phase.get('compile_cached', False): # Recorded by an older MBI
+            builds[phase.get('compile_pch', False)][num] = phase['compile']
+    for (pch, name) in [(True, 'mean_compile_pch'), (False, 'mean_compile_nopch')]:
+        res['build'] += sum(builds[pch].values())
+        if len(builds[pch]) > 0:
+            res[name] = sum(builds[pch].values()) / len(builds[pch])
+    if len(phases) > 0:
+        res['mean_compile'] = res['compile'] / len(phases)
+        res['mean_analysis'] = res['analysis'] / len(phases)
+    return res
+
+def timing_samples(tool, toolname, test_id):
+    """
+    The elapsed times of all runs of that test (from the root directory): its own run, plus its repetitions if the tests were run with --repeat-timing.
+    The runs that did not give a verdict (timeout, memout, failure) are not counted, nor the repetitions made with another cache key than the test itself.
+    """
+    samples = []
+    cachekeys = [None]
+    rep = 0
+    while True:
+        run_id = test_id if rep == 0 else f'{test_id}-rep{rep}'
+        if not os.path.exists(f'logs/{toolname}/{run_id}.elapsed') and stored_result(tool, toolname, run_id) is None:
+            break
+        cachekey = recorded_key(run_id, f'logs/{toolname}')
+        if rep == 0:
+            cachekeys[0] = cachekey
+        (res_category, elapsed, diagnostic, outcome) = categorize(tool=tool, toolname=toolname, test_id=run_id, expected='OK')
+        if res_category not in ['timeout', 'memout', 'failure'] and elapsed is not None and (rep == 0 or cachekey == cachekeys[0]):
+            samples.append(float(elapsed))
+        rep += 1
+    return samples
+
+def quantile(values, q):
+    """The q-quantile of these sorted values, interpolated linearly between the closest ranks."""
+    pos = (len(values) - 1) * q
+    low = int(math.floor(pos))
+    high = min(low + 1, len(values) - 1)
+    return values[low] + (values[high] - values[low]) * (pos - low)
+
+def summarize_timings(samples):
+    """
+    Robust statistics over several timings: median, quartiles and interquartile range, and 95% confidence interval of the median, or None if there is no sample.
+
+    The confidence interval is distribution-free: it is given by the order statistics x(k) and x(n-k+1), for the largest k such that the probability for a Binomial(n, 1/2)
+    to be below k is at most 2.5%. It needs at least 6 samples, and is None below that.
+    """
+    if len(samples) == 0:
+        return None
+    values = sorted(samples)
+    n = len(values)
+    res = {'runs': n, 'median': quantile(values, 0.5), 'q1': quantile(values, 0.25), 'q3': quantile(values, 0.75), 'ci': None}
+    res['iqr'] = res['q3'] - res['q1']
+    (k, tail) = (0, 0)
+    while k < n:
+        tail += math.factorial(n) / (math.factorial(k) * math.factorial(n - k)) / 2**n # P(Binomial(n, 1/2) = k)
+        if tail > 0.025:
+            break
+        k += 1
+    if k > 0:
+        res['ci'] = (values[k - 1], values[n - k])
+    return res
+
+def timings2human(summary, samples='runs'):
+    """Short display of the result of summarize_timings()"""
+    if summary is None:
+        return '-'
+    res = f"{round(summary['median'], 2)} s (IQR {round(summary['iqr'], 2)} s"
+    if summary['ci'] is not None:
+        res += f", 95% CI [{round(summary['ci'][0], 2)}, {round(summary['ci'][1], 2)}]"
+    return res + f", {summary['runs']} {samples})"
+
+def read_stats(tool, toolname, test_id):
+    """Returns the statistics recorded for that test (see the .stats files), from the result store if possible, or an empty dictionary."""
+    stats = stored_stats(tool, toolname, test_id)
+    if stats is None:
+        for filename in [f'{test_id}.stats', f'logs/{toolname}/{test_id}.stats']:
+            if os.path.exists(filename):
+                with open(filename, 'r') as infile:
+                    stats = infile.read()
+                break
+    try:
+        return json.loads(stats) if stats is not None else {}
+    except ValueError:
+        return {}
+
+subreaper = False
+def become_subreaper():
+    """Get the orphaned descendants of this process reparented to it rather than to init (Linux only)"""
+    global subreaper
+    if not subreaper:
+        subreaper = True
+        try:
+            ctypes.CDLL(None, use_errno=True).prctl(36, 1, 0, 0, 0) # PR_SET_CHILD_SUBREAPER
+        except (OSError, AttributeError):
+            pass
+
+def child_processes():
+    """The pids of the processes whose parent is the current process (Linux only)"""
+    res = []
+    try:
+        pids = [pid for pid in os.listdir('/proc') if pid.isdigit()]
+    except OSError:
+        return res
+    for pid in pids:
+        try:
+            with open(f'/proc/{pid}/stat', 'r') as infile:
+                stat = infile.read()
+        except OSError:
+            continue # That process is gone already
+        if int(stat[stat.rindex(')')+2:].split()[1]) == os.getpid():
+            res.append(int(pid))
+    return res
+
+class OutputCapture:
+    """
+    Collects the output of a tool, keeping at most `cap` bytes in memory (or everything if cap is 0).
+
+    When the output grows larger, only its head and its tail are kept, along with the lines of the middle matching one of the verdict patterns.
+    The full output is then streamed to a compressed file, and echoed to the terminal only up to the cap.
+    """
+    def __init__(self, header, cap, verdicts, full_filename):
+        self.cap = cap
+        self.full_filename = full_filename
+        self.verdict = re.compile('|'.join(f'(?:{pattern})' for pattern in verdicts)) if len(verdicts) > 0 else None
+        self.head = [header]
+        self.head_size = len(header)
+        self.tail = collections.deque()
+        self.tail_size = 0
+        self.kept = []  # Verdict lines from the truncated part
+        self.elided = 0  # Amount of lines removed from the middle
+        self.full = None
+        self.pending = b''  # The incomplete last line of the raw output
+
+    def feed(self, data, final=False):
+        """Add a chunk of the raw tool output, and returns the lines that it completes (along with the last incomplete line, if that's the final chunk)."""
+        lines = (self.pending + data).split(b'\n')
+        self.pending = lines.pop()
+        lines = [line + b'\n' for line in lines]
+        if (final or len(self.pending) > 1024*1024) and self.pending != b'': # Don't wait forever for the end of the line
+            lines.append(self.pending)
+            self.pending = b''
+        # From byte array to string, replacing non-representable strings with question marks
+        lines = [str(line, errors='replace') for line in lines]
+        for line in lines:
+            self.write(line)
+        return lines
+
+    def write(self, line):
+        if self.cap == 0 or self.head_size + len(line) <= self.cap // 2:
+            self.head.append(line)
+            self.head_size += len(line)
+            print(f"| {line}", end='', file=sys.stderr)
+            return
+        if self.full is None:
+            print(f"| [... output larger than {self.cap // 2} bytes, not shown here ...]", file=sys.stderr)
+            self.full = gzip.open(self.full_filename, 'wt', compresslevel=3)
+            self.full.writelines(self.head)
+        self.tail.append(line)
+        self.tail_size += len(line)
+        while self.tail_size > self.cap // 2 and len(self.tail) > 1:
+            dropped = self.tail.popleft()
+            self.tail_size -= len(dropped)
+            self.full.write(dropped)
+            if self.verdict is not None and self.verdict.search(dropped):
+                self.kept.append(dropped)
+            else:
+                self.elided += 1
+
+    def save(self, outfile):
+        """Write the retained output to that file, and complete the compressed full output on need."""
+        outfile.writelines(self.head)
+        if self.elided > 0:
+            outfile.write(f"\n[... {self.elided} lines elided. The full output is in {self.full_filename}. Below are the elided lines matching the verdicts of the tool ...]\n")
+            outfile.writelines(self.kept)
+            outfile.write("[... end of the elided lines ...]\n")
+        else:
+            outfile.writelines(self.kept)
+        outfile.writelines(self.tail)
+        if self.full is not None:
+            self.full.writelines(self.tail)
+            self.full.close()
+            if self.elided == 0: # Everything fits in the .txt
+                os.remove(self.full_filename)
+
+# The digests of the tool binaries, computed once per process when checking the run journal (see AbstractTool.journaled())
+journaled_digests = {}
+
+def binary_digest(path, rootdir):
+    """
+    Returns the md5sum of that file, or None if it does not exist.
+    The digests are memoized in {rootdir}/cache/binaries.json along with the size and date of the files, so that large tool binaries are not hashed for every test.
+    """
+    try:
+        stat = os.stat(path)
+    except OSError:
+        return None
+    memo_file = f'{rootdir}/cache/binaries.json'
+    try:
+        with open(memo_file, 'r') as infile:
+            memo = json.load(infile)
+    except (OSError, ValueError):
+        memo = {}
+    if path in memo and memo[path][0] == stat.st_mtime_ns and memo[path][1] == stat.st_size:
+        return memo[path][2]
+
+    hashed = hashlib.md5()
+    with open(path, 'rb') as binfile:
+        for chunk in iter(lambda: binfile.read(1024*1024), b""):
+            hashed.update(chunk)
+    memo[path] = [stat.st_mtime_ns, stat.st_size, hashed.hexdigest()]
+    os.makedirs(f'{rootdir}/cache', exist_ok=True)
+    with open(f'{memo_file}.{os.getpid()}', 'w') as outfile:
+        json.dump(memo, outfile, indent=1)
+    os.replace(f'{memo_file}.{os.getpid()}', memo_file)
+    return memo[path][2]
+
+def filesystem_type(path):
+    """The type of the file system holding that path (such as 'tmpfs' or 'ext4'), according to the longest matching mount point of /proc/self/mountinfo, or None."""
+    path = os.path.realpath(path)
+    (best, res) = ('', None)
+    try:
+        with open('/proc/self/mountinfo', 'r') as infile:
+            for line in infile:
+                (mountpoint, fstype) = (line.split(' - ')[0].split()[4], line.split(' - ')[1].split()[0])
+                if (path == mountpoint or path.startswith(mountpoint.rstrip('/') + '/')) and len(mountpoint) >= len(best):
+                    (best, res) = (mountpoint, fstype)
+    except (OSError, IndexError):
+        pass
+    return res
+
+def leading_includes(filename):
+    """The #include lines at the beginning of that code (before anything else than comments and blank lines)"""
+    includes = []
+    in_comment = False
+    with open(filename, 'r', errors='replace') as infile:
+        for line in infile:
+            line = line.strip()
+            if in_comment:
+                if '*/' in line:
+                    in_comment = False
+                    line = line[line.index('*/')+2:].strip()
+                else:
+                    continue
+            if line.startswith('/*') and '*/' not in line:
+                in_comment = True
+            elif line == '' or line.startswith('//') or (line.startswith('/*') and line.endswith('*/')):
+                pass
+            elif re.match(r'#include\s*<[^>]*>$', line):
+                includes.append(line)
+            else:
+                break
+    return includes
+
+compiler_versions = {}
+def compiler_version(compiler):
+    """Returns the output of 'compiler --version', which is only computed once per compiler and process."""
+    if compiler not in compiler_versions:
+        version = subprocess.run([compiler, '--version'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        compiler_versions[compiler] = version.stdout or b''
+    return compiler_versions[compiler]
+
 # Associate all possible detailed outcome to a given error scope. Scopes must be sorted alphabetically.
 possible_details = {
     # scope limited to one call
@@ -211,6 +1127,9 @@ possible_details = {
     'IHCallMatching':'InputHazard',
     'OK':'FOK'}
 
+# The nondeterministic error scopes, whose tests are run 5 times each (as separate tests) to give a chance to the tools to see the error
+nondeterministic_scopes = ['BLocalConcurrency', 'DRace', 'DGlobalConcurrency']
+
 error_scope = {
     'AInvalidParam':'single call',
     'BResLeak':'single process',
@@ -271,6 +1190,51 @@ displayed_name = {
     'RMA':'RMA',
 }
 
+possible_features=['P2P!basic', 'P2P!nonblocking', 'P2P!persistent', 'COLL!basic', 'COLL!nonblocking', 'COLL!persistent', 'COLL!tools', 'RMA']
+possible_characterization=["Lacking", "Yes"]
+
+def read_file_features(file):
+    """Takes a filename and returns a tuple (correct, lacking) of lists of features, read from its header"""
+    correct = []
+    lacking = []
+    with open(file, 'r') as f:
+        line = f.readline()
+
+        # Search for the feature block
+        while line != 'BEGIN_MPI_FEATURES\n':
+            if line == '':
+                raise Exception("Impossible to find the feature block in {}".format(file))
+            line = f.readline()
+
+        while line != 'END_MPI_FEATURES\n':
+            if line == '':
+                raise Exception("Impossible to find the end of the feature block in {}".format(file))
+
+            line = line.strip()
+            matching = re.match("^ *([!a-zA-Z0-9]*): ([a-zA-Z0-9]*)$", line)
+            if matching is not None:
+                (feat, chara) = (matching.group(1), matching.group(2))
+                if feat not in possible_features:
+                    raise Exception("ERROR: file {} contains an unknown feature: '{}'".format(file, feat))
+                if chara not in possible_characterization:
+                    raise Exception("ERROR: file {} have feature {} with unknown characterization: '{}'".format(file, feat, chara))
+                if chara == 'Yes':
+                    correct.append(feat)
+                elif chara == 'Lacking':
+                    lacking.append(feat)
+                else:
+                    raise Exception("Impossible")
+            line = f.readline()
+    if len(correct) > 4:
+        raise Exception(f"ERROR: file {file} has more than one 4 features: {correct}")
+    return (correct, lacking)
+
+def parse_file_features(file):
+    """Takes a filename and returns a tuple (correct, lacking) of lists of features, from the index of the codes if it was loaded (see CodeIndex)"""
+    if code_index is not None and code_index.covers(file):
+        return code_index.features(file)
+    return read_file_features(file)
+
 def parse_one_code(filename):
     """
     Reads the header of the provided filename, and extract a list of todo item, each of them being a (cmd, expect, test_num) tupple.
@@ -278,10 +1242,14 @@ def parse_one_code(filename):
     """
     res = []
     test_num = 0
+    # The generator family of this code (used to predict its duration), or the prefix of its name if it was not generated
+    generator = re.sub('_.*', '', os.path.basename(filename))
     with open(filename, "r") as input_file:
         state = 0  # 0: before header; 1: in header; 2; after header
         line_num = 1
         for line in input_file:
+            if state == 0 and re.match(".*generated by ([^ ]*)Generator.py", line):
+                generator = re.match(".*generated by ([^ ]*)Generator.py", line).group(1)
             if re.match(".*BEGIN_MBI_TESTS.*", line):
                 if state == 0:
                     state = 1
@@ -310,13 +1278,17 @@ def parse_one_code(filename):
                         raise ValueError(
                             f"\n{filename}:{line_num}: MBI parse error: Detailled outcome {detail} is not one of the allowed ones.")
 
-                if possible_details[detail] in ['BLocalConcurrency', 'DRace', 'DGlobalConcurrency']:
-                    for i in [0,1,2,3,4]:
-                        test = {'filename': filename, 'id': test_num, 'cmd': cmd, 'expect': expect, 'detail': detail}
+                # Amount of MPI processes used by this test, to reserve as many cores when running it
+                m = re.search(r'-np +([0-9]+)', cmd)
+                np = int(m.group(1)) if m else 1
+
+                if possible_details[detail] in nondeterministic_scopes:
+                    for i in range(repeat_count):
+                        test = {'filename': filename, 'id': test_num, 'cmd': cmd, 'expect': expect, 'detail': detail, 'np': np, 'generator': generator, 'repeat': i}
                         res.append(test.copy())
                         test_num += 1
                 else:
-                   test = {'filename': filename, 'id': test_num, 'cmd': cmd, 'expect': expect, 'detail': detail}
+                   test = {'filename': filename, 'id': test_num, 'cmd': cmd, 'expect': expect, 'detail': detail, 'np': np, 'generator': generator}
                    res.append(test.copy())
                    test_num += 1
 
@@ -331,6 +1303,165 @@ def parse_one_code(filename):
         raise ValueError(f"No test found in {filename}. Please fix it.")
     return res
 
+# Amount of times that the tests of the nondeterministic categories are run
+repeat_count = 5
+
+def repeat_group(test):
+    """The repeats of a nondeterministic test (see parse_one_code()) share the same group, identified by the file name and the id of their first repeat. Returns None for the other tests."""
+    if 'repeat' not in test:
+        return None
+    return (test['filename'], test['id'] - test['repeat'])
+
+def repeat_seed(test_id):
+    """The scheduling seed given to that repeat of a nondeterministic test: distinct for each repeat, and the same from one campaign to the next so that the results stay reproducible."""
+    return int(hashlib.md5(test_id.encode()).hexdigest()[:8], 16)
+
+def skipped_repeat(toolname, test_id):
+    """Whether that repeat was not run by that tool because the class of its test was already settled by the other repeats (see settled_category())."""
+    return os.path.exists(f'{test_id}.skipped') or os.path.exists(f'logs/{toolname}/{test_id}.skipped')
+
+class CodeIndex:
+    """
+    Index of the test codes (index.json in their directory): the size, date and digest of each code, the tests declared in its header (as returned by parse_one_code()) and its feature labels.
+
+    Loading it spares parsing the headers of all codes at each command. The entry of a code is used as long as the code has the same size and date, or the same digest.
+    The other codes are parsed again, and the index is updated. The whole index is discarded when the header parsers change.
+    """
+    def __init__(self, directory):
+        self.directory = directory
+        self.realdir = os.path.realpath(directory)
+        self.filename = f'{directory}/index.json'
+        self.version = hashlib.md5((inspect.getsource(parse_one_code) + inspect.getsource(read_file_features)).encode()).hexdigest()
+        self.entries = {}
+        self.dirty = False
+        if os.path.exists(self.filename):
+            try:
+                with open(self.filename, 'r') as infile:
+                    index = json.load(infile)
+                if index.get('version') == self.version:
+                    self.entries = index['codes']
+            except (OSError, ValueError, KeyError):
+                pass
+
+    def covers(self, filename):
+        return os.path.realpath(os.path.dirname(filename)) == self.realdir
+
+    def entry(self, filename):
+        """The entry of that code, checked against the code itself and updated on need"""
+        name = os.path.basename(filename)
+        stat = os.stat(filename)
+        entry = self.entries.get(name)
+        if entry is not None and [entry['size'], entry['mtime_ns']] != [stat.st_size, stat.st_mtime_ns]:
+            with open(filename, 'rb') as infile:
+                digest = hashlib.sha256(infile.read()).hexdigest()
+            if entry['sha256'] == digest: # Only touched
+                (entry['size'], entry['mtime_ns']) = (stat.st_size, stat.st_mtime_ns)
+                self.dirty = True
+            else:
+                entry = None
+        if entry is None:
+            with open(filename, 'rb') as infile:
+                digest = hashlib.sha256(infile.read()).hexdigest()
+            try:
+                features = list(read_file_features(filename))
+            except Exception: # Reported if the features of that code are ever needed
+                features = None
+            entry = {'size': stat.st_size, 'mtime_ns': stat.st_mtime_ns, 'sha256': digest,
+                     'tests': [dict(test, filename=name) for test in parse_one_code(filename)], 'features': features}
+            self.entries[name] = entry
+            self.dirty = True
+        return entry
+
+    def tests(self, filename):
+        """The tests of that code, as returned by parse_one_code()"""
+        return [dict(test, filename=filename) for test in self.entry(filename)['tests']]
+
+    def features(self, filename):
+        """The features of that code, as returned by read_file_features()"""
+        if self.entry(filename)['features'] is None:
+            return read_file_features(filename)
+        (correct, lacking) = self.entry(filename)['features']
+        return (correct, lacking)
+
+    def save(self, filenames):
+        """Write the index back if it changed, only keeping the given codes"""
+        names = set(os.path.basename(filename) for filename in filenames)
+        for name in [name for name in self.entries if name not in names]:
+            del self.entries[name]
+            self.dirty = True
+        if not self.dirty:
+            return
+        try:
+            with open(f'{self.filename}.{os.getpid()}', 'w') as outfile:
+                json.dump({'version': self.version, 'codes': self.entries}, outfile, sort_keys=True, separators=(',', ':'))
+            os.replace(f'{self.filename}.{os.getpid()}', self.filename)
+            self.dirty = False
+        except OSError as e: # Read-only codes directory: the headers will be parsed again next time
+            print(f"Cannot save the index of the codes in {self.filename}: {e}")
+
+# The index of the codes loaded by MBI.py, used by parse_file_features() if not None
+code_index = None
+
+def init_generator_worker(directory):
+    """Prepare a process of the pool running the code generators: their shared module is only imported once per process."""
+    sys.path.insert(0, directory)
+    import generator_utils
+
+def run_generator(generator):
+    """
+    Run that code generator in the current process (from the directory of the generated codes), as if it were run as a script.
+    Returns the names of the codes it wrote, and the combinations that it skipped when generating a covering array (see generator_utils.covered()).
+    """
+    import generator_utils
+    del generator_utils.generated[:]
+    del generator_utils.skipped[:]
+    sys.argv = [generator] # The generators name themselves in the header of their codes
+    runpy.run_path(generator, run_name='__main__')
+    return (list(generator_utils.generated), list(generator_utils.skipped))
+
+def update_generated(staging, directory, generated):
+    """
+    Move the codes generated in the staging directory to the codes directory, only replacing the files whose content changed so that the other ones keep their date,
+    and remove the files that are not generated anymore. The codes are given per generator ({generator: [filename, ...]}), each with its numbered .c.txt view.
+    The manifest of the codes directory (manifest.json) records the digest and the generator of each file. Returns the amount of added, changed and removed codes per generator.
+    """
+    previous = {}
+    if os.path.exists(f'{directory}/manifest.json'):
+        try:
+            with open(f'{directory}/manifest.json', 'r') as infile:
+                previous = json.load(infile)
+        except ValueError:
+            pass
+    manifest = {}
+    changes = {}
+    def count(generator, filename, change):
+        if filename.endswith('.c'):
+            changes.setdefault(generator, {'added': 0, 'changed': 0, 'removed': 0})[change] += 1
+
+    for (generator, filenames) in generated.items():
+        for filename in [name for code in filenames for name in [code, f'{code}.txt']]:
+            with open(f'{staging}/{filename}', 'rb') as infile:
+                digest = hashlib.sha256(infile.read()).hexdigest()
+            manifest[filename] = {'sha256': digest, 'generator': generator}
+            if os.path.exists(f'{directory}/{filename}'):
+                with open(f'{directory}/{filename}', 'rb') as infile: # Not trusting the previous manifest, in case the file was modified by hand
+                    if hashlib.sha256(infile.read()).hexdigest() == digest:
+                        continue
+                count(generator, filename, 'changed')
+            else:
+                count(generator, filename, 'added')
+            os.replace(f'{staging}/{filename}', f'{directory}/{filename}')
+    for filename in sorted(os.listdir(directory)):
+        if filename not in manifest and filename not in ['manifest.json', 'index.json', 'covering.json'] and os.path.isfile(f'{directory}/{filename}'):
+            os.remove(f'{directory}/{filename}')
+            count(previous.get(filename, {}).get('generator', 'unknown'), filename, 'removed')
+
+    with open(f'{directory}/manifest.json.tmp', 'w') as outfile:
+        json.dump(manifest, outfile, indent=1, sort_keys=True)
+    os.replace(f'{directory}/manifest.json.tmp', f'{directory}/manifest.json')
+    shutil.rmtree(staging)
+    return changes
+
 cache_categorize = {}
 
 def categorize(tool, toolname, test_id, expected, autoclean=False):
@@ -338,16 +1469,25 @@ def categorize(tool, toolname, test_id, expected, autoclean=False):
     if cache_id in cache_categorize:
         return cache_categorize[cache_id]
 
-    outcome = tool.parse(test_id)
-
-    if not os.path.exists(f'{test_id}.elapsed') and not os.path.exists(f'logs/{toolname}/{test_id}.elapsed'):
-        if outcome == 'failure':
+    stored = stored_result(tool, toolname, test_id)
+    if stored is not None:
+        (outcome, elapsed) = stored
+        if elapsed is None:
             elapsed = 0
-        else:
-            raise ValueError(f"Invalid test result: {test_id}.txt exists but not {test_id}.elapsed")
     else:
-        with open(f'{test_id}.elapsed' if os.path.exists(f'{test_id}.elapsed') else f'logs/{toolname}/{test_id}.elapsed', 'r') as infile:
-            elapsed = infile.read()
+        if os.path.exists(f'{test_id}.memout') or os.path.exists(f'logs/{toolname}/{test_id}.memout'): # The tool parsers know nothing about the resource limits
+            outcome = 'memout'
+        else:
+            outcome = tool.parse(test_id)
+
+        if not os.path.exists(f'{test_id}.elapsed') and not os.path.exists(f'logs/{toolname}/{test_id}.elapsed'):
+            if outcome == 'failure':
+                elapsed = 0
+            else:
+                raise ValueError(f"Invalid test result: {test_id}.txt exists but not {test_id}.elapsed")
+        else:
+            with open(f'{test_id}.elapsed' if os.path.exists(f'{test_id}.elapsed') else f'logs/{toolname}/{test_id}.elapsed', 'r') as infile:
+                elapsed = infile.read()
 
     # Properly categorize this run
     if outcome == 'timeout':
@@ -356,14 +1496,14 @@ def categorize(tool, toolname, test_id, expected, autoclean=False):
             diagnostic = f'hard timeout'
         else:
             diagnostic = f'timeout after {elapsed} sec'
+    elif outcome == 'memout':
+        res_category = 'memout'
+        diagnostic = f'memory budget exceeded after {elapsed} sec'
     elif outcome == 'failure' or outcome == 'segfault':
         res_category = 'failure'
         diagnostic = f'tool error, or test not run'
         if autoclean:
-            if os.path.exists(f'{test_id}.md5sum'):
-                os.unlink(f'{test_id}.md5sum')
-            elif os.path.exists(f'logs/{toolname}/{test_id}.md5sum'):
-                os.unlink(f'logs/{toolname}/{test_id}.md5sum')
+            forget_cached_result(toolname, test_id)
     elif outcome == 'UNIMPLEMENTED':
         res_category = 'unimplemented'
         diagnostic = f'coverage issue'
@@ -371,10 +1511,7 @@ def categorize(tool, toolname, test_id, expected, autoclean=False):
         res_category = 'other'
         diagnostic = f'inconclusive run'
         if autoclean:
-            if os.path.exists(f'{test_id}.md5sum'):
-                os.unlink(f'{test_id}.md5sum')
-            elif os.path.exists(f'logs/{toolname}/{test_id}.md5sum'):
-                os.unlink(f'logs/{toolname}/{test_id}.md5sum')
+            forget_cached_result(toolname, test_id)
     elif expected == 'OK':
         if outcome == 'OK':
             res_category = 'TRUE_NEG'
@@ -396,6 +1533,15 @@ def categorize(tool, toolname, test_id, expected, autoclean=False):
 
     return (res_category, elapsed, diagnostic, outcome)
 
+def forget_cached_result(toolname, test_id):
+    """Remove the cache files of that test, so that it gets run again next time"""
+    for ext in ['md5sum', 'cachekey']:
+        if os.path.exists(f'{test_id}.{ext}'):
+            os.unlink(f'{test_id}.{ext}')
+        elif os.path.exists(f'logs/{toolname}/{test_id}.{ext}'):
+            os.unlink(f'logs/{toolname}/{test_id}.{ext}')
+    forget_result(toolname, test_id)
+
 # Extended categorization
 
 def categorize_extended(results, expected, detail):
@@ -403,7 +1549,7 @@ def categorize_extended(results, expected, detail):
 
     result = {"result": res, 'expected': expected, 'detail': detail,
               "FALSE_POS":0, "TRUE_NEG":0, "TRUE_POS":0, "FALSE_NEG":0,
-              "unimplemented":0, "timeout":0, "failure":0, "other":0}
+              "unimplemented":0, "timeout":0, "memout":0, "failure":0, "other":0}
 
     for res in results:
         result[res] += 1
@@ -413,7 +1559,7 @@ def categorize_extended(results, expected, detail):
     FN = result['FALSE_NEG']
     FP = result['FALSE_POS']
     CE = result['unimplemented']
-    TO = result['timeout']
+    TO = result['timeout'] + result['memout'] # Both mean that the tool exhausted its budget
     RE = result['failure']
     O  = result['other']
 
@@ -452,6 +1598,16 @@ def categorize_extended(results, expected, detail):
 
     return result
 
+def settled_category(results, expected):
+    """
+    The extended category of a nondeterministic test that no further repeat can change, given the categories of its repeats that are done, or None if it is not settled yet.
+    Once an erroneous code was both detected and missed (or any other outcome), it is a CTP whatever the other repeats give; same for a correct code with a false positive (CFP).
+    """
+    flagged = 'FALSE_POS' if expected == 'OK' else 'TRUE_POS'
+    if flagged in results and any(res != flagged for res in results):
+        return 'CFP' if expected == 'OK' else 'CTP'
+    return None
+
 def categorize_all_files(tool, toolname, tests, check_diagnostic=True):
     res = {}
     results = {}
@@ -472,6 +1628,8 @@ def categorize_all_files(tool, toolname, tests, check_diagnostic=True):
         binary=re.sub('\.c', '', os.path.basename(test['filename']))
         ID=test['id']
         test_id = f"{binary}_{ID}"
+        if skipped_repeat(toolname, test_id):
+            continue
 
         (res_category, elapsed, diagnostic, outcome) = categorize(tool=tool, toolname=toolname, test_id=test_id, expected=test['expect'], autoclean=False)
 
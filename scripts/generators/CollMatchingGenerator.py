@@ -86,6 +86,8 @@ int main(int argc, char **argv) {
 
 for c1 in gen.coll + gen.icoll + gen.ibarrier:
     for c2 in gen.coll + gen.icoll + gen.ibarrier:
+        if not gen.covered('CollMatching', (c1, c2), [gen.coll + gen.icoll + gen.ibarrier, gen.coll + gen.icoll + gen.ibarrier]):
+            continue
         patterns = {}
         patterns = {'c1': c1, 'c2': c2}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -88,6 +88,8 @@ int main(int argc, char **argv) {
 for s in gen.send + gen.isend:
     for r in gen.recv + gen.irecv:
         for c in gen.coll:
+            if not gen.covered('CollP2PMatching', (s, r, c), [gen.send + gen.isend, gen.recv + gen.irecv, gen.coll]):
+                continue
             patterns = {}
             patterns = {'s': s, 'r': r, 'c': c}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
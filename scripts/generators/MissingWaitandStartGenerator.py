@@ -84,6 +84,8 @@ int main(int argc, char **argv) {
 
 for s in gen.isend + gen.psend:
     for r in gen.irecv + gen.precv:
+        if not gen.covered('MissingWaitandStart', (s, r), [gen.isend + gen.psend, gen.irecv + gen.precv]):
+            continue
         patterns = {}
         patterns = {'s': s, 'r': r}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -82,6 +82,8 @@ int main(int argc, char **argv) {
 
 for p1 in gen.allsend:
     for p2 in gen.allrecv:
+        if not gen.covered('P2PArg#1', (p1, p2), [gen.allsend, gen.allrecv]):
+            continue
         patterns = {}
         patterns = {'p1': p1, 'p2': p2}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -134,6 +136,8 @@ for p1 in gen.allsend:
 
 for p1 in gen.allsend:
     for p2 in gen.allrecv:
+        if not gen.covered('P2PArg#2', (p1, p2), [gen.allsend, gen.allrecv]):
+            continue
         patterns = {}
         patterns = {'p1': p1, 'p2': p2}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
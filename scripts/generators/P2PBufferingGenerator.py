@@ -88,6 +88,8 @@ int main(int argc, char **argv) {
 
 for s in gen.send + gen.isend:
     for r in gen.recv + gen.irecv:
+        if not gen.covered('P2PBuffering', (s, r), [gen.send + gen.isend, gen.recv + gen.irecv]):
+            continue
         patterns = {}
         patterns = {'s': s, 'r': r}
         patterns['origin'] = 'MBI'
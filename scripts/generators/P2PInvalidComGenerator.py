@@ -79,6 +79,8 @@ int main(int argc, char **argv) {
 
 for p1 in gen.send + gen.isend + gen.psend:
     for p2 in gen.recv + gen.irecv + gen.precv:
+        if not gen.covered('P2PInvalidCom', (p1, p2), [gen.send + gen.isend + gen.psend, gen.recv + gen.irecv + gen.precv]):
+            continue
         patterns = {}
         patterns = {'p1': p1, 'p2': p2}
         patterns['origin'] = "MBI"
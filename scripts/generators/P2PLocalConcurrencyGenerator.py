@@ -81,6 +81,8 @@ int main(int argc, char **argv) {
 
 for s in gen.send + gen.isend + gen.psend:
     for r in gen.irecv + gen.precv + gen.recv:
+        if not gen.covered('P2PLocalConcurrency', (s, r), [gen.send + gen.isend + gen.psend, gen.irecv + gen.precv + gen.recv]):
+            continue
         patterns = {}
         patterns = {'s': s, 'r': r}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -116,6 +116,8 @@ for p in gen.send + gen.ssend + gen.bsend + gen.recv + gen.irecv + gen.isend:
 
 for s in gen.send + gen.isend + gen.ssend + gen.bsend:
     for r in gen.recv + gen.irecv:
+        if not gen.covered('P2PMatching', (s, r), [gen.send + gen.isend + gen.ssend + gen.bsend, gen.recv + gen.irecv]):
+            continue
         patterns = {}
         patterns = {'s': s, 'r': r}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -122,6 +122,8 @@ basedesc = 'We have 4 processes (p0, p1, p2 and p3). p1 and p2 send N messages t
 
 for s in gen.send + gen.isend:
     for r in gen.recv + gen.irecv:
+        if not gen.covered('P2PMessageRace', (s, r), [gen.send + gen.isend, gen.recv + gen.irecv]):
+            continue
         patterns = {}
         patterns = {'s': s, 'r': r}
         patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -96,6 +96,8 @@ int main(int argc, char **argv) {
 for p in gen.probe:
     for s in gen.send + gen.isend:
         for r in gen.recv + gen.irecv:
+            if not gen.covered('P2PProbe', (p, s, r), [gen.probe, gen.send + gen.isend, gen.recv + gen.irecv]):
+                continue
             patterns = {}
             patterns = {'p':p, 's': s, 'r': r}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
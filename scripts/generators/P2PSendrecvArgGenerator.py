@@ -89,6 +89,8 @@ int main(int argc, char **argv) {
 for s in gen.send:
     for r in gen.recv:
         for sr in gen.sendrecv:
+            if not gen.covered('P2PSendrecvArg', (s, r, sr), [gen.send, gen.recv, gen.sendrecv]):
+                continue
             patterns = {}
             patterns = {'s': s, 'r': r, 'sr': sr}
             patterns['origin'] = "RTED"
@@ -77,6 +77,8 @@ int main(int argc, char **argv) {
 
 for e in gen.epoch:
     for p in gen.rma:
+        if not gen.covered('RMAArg', (e, p), [gen.epoch, gen.rma]):
+            continue
         patterns = {}
         patterns = {'e': e, 'p': p}
         patterns['origin'] = "MBI"
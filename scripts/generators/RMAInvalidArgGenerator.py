@@ -75,6 +75,8 @@ int main(int argc, char **argv) {
 
 for e in gen.epoch:
     for p in gen.rma:
+        if not gen.covered('RMAInvalidArg', (e, p), [gen.epoch, gen.rma]):
+            continue
         patterns = {}
         patterns = {'e': e, 'p': p}
         patterns['origin'] = "MBI"
@@ -79,6 +79,8 @@ int main(int argc, char **argv) {
 for e in gen.epoch:
     for p1 in gen.get:
         for p2 in gen.put + gen.store + gen.load + gen.get + gen.loadstore:
+            if not gen.covered('RMALocalLocalConcurrency#1', (e, p1, p2), [gen.epoch, gen.get, gen.put + gen.store + gen.load + gen.get + gen.loadstore]):
+                continue
             patterns = {}
             patterns = {'e': e, 'p1': p1, 'p2': p2}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -124,6 +126,8 @@ for e in gen.epoch:
 for e in gen.epoch:
     for p1 in gen.put:
         for p2 in gen.store:
+            if not gen.covered('RMALocalLocalConcurrency#2', (e, p1, p2), [gen.epoch, gen.put, gen.store]):
+                continue
             patterns = {}
             patterns = {'e': e, 'p1': p1, 'p2': p2}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -95,6 +95,8 @@ int main(int argc, char **argv) {
 for p in gen.put + gen.get:
     for s in gen.send + gen.isend:
         for r in gen.recv + gen.irecv:
+            if not gen.covered('RMAP2PGlobalConcurrency', (p, s, r), [gen.put + gen.get, gen.send + gen.isend, gen.recv + gen.irecv]):
+                continue
             patterns = {}
             patterns = {'p': p, 's': s, 'r': r}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -81,6 +81,8 @@ int main(int argc, char **argv) {
 for e in gen.epoch:
     for p1 in gen.get:
         for p2 in gen.put + gen.rstore + gen.rload + gen.get :
+            if not gen.covered('RMARemoteLocalConcurrency#1', (e, p1, p2), [gen.epoch, gen.get, gen.put + gen.rstore + gen.rload + gen.get]):
+                continue
             patterns = {}
             patterns = {'e': e, 'p1': p1, 'p2': p2}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -120,6 +122,8 @@ for e in gen.epoch:
 for e in gen.epoch:
     for p1 in gen.put:
         for p2 in gen.rstore + gen.rload + gen.put + gen.get:
+            if not gen.covered('RMARemoteLocalConcurrency#2', (e, p1, p2), [gen.epoch, gen.put, gen.rstore + gen.rload + gen.put + gen.get]):
+                continue
             patterns = {}
             patterns = {'e': e, 'p1': p1, 'p2': p2}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
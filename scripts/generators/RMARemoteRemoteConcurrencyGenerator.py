@@ -81,6 +81,8 @@ int main(int argc, char **argv) {
 for e in gen.epoch:
     for p1 in gen.get + gen.put:
         for p2 in gen.put:
+            if not gen.covered('RMARemoteRemoteConcurrency', (e, p1, p2), [gen.epoch, gen.get + gen.put, gen.put]):
+                continue
             patterns = {}
             patterns = {'e': e, 'p1': p1, 'p2': p2}
             patterns['generatedby'] = f'DO NOT EDIT: this file was generated by {os.path.basename(sys.argv[0])}. DO NOT EDIT.'
@@ -82,6 +82,8 @@ int main(int argc, char **argv) {
 
 for e1 in gen.epoch:
     for p in gen.rma:
+        if not gen.covered('RMAReqLifecycle#1', (e1, p), [gen.epoch, gen.rma]):
+            continue
         patterns = {}
         patterns = {'e1': e1, 'p': p}
         patterns['origin'] = "MPI-Corrbench"
@@ -126,6 +128,8 @@ for e1 in gen.epoch:
 for e1 in gen.epoch:
     for e2 in gen.epoch:
         for p in gen.rma:
+            if not gen.covered('RMAReqLifecycle#2', (e1, e2, p), [gen.epoch, gen.epoch, gen.rma]):
+                continue
             patterns = {}
             patterns = {'e1': e1, 'e2': e2, 'p': p}
             patterns['origin'] = "MPI-Corrbench"
@@ -5,6 +5,8 @@
 
 import os
 import re
+import itertools
+import collections
 
 # Collectives
 coll = ['MPI_Barrier', 'MPI_Bcast', 'MPI_Reduce', 'MPI_Gather', 'MPI_Scatter', 'MPI_Scan', 'MPI_Exscan', 'MPI_Allgather', 'MPI_Allreduce', 'MPI_Allgatherv', 'MPI_Alltoall', 'MPI_Alltoallv']
@@ -426,40 +428,112 @@ operation['loadstore'] = lambda n: f'if (localbuf{n}[0] % 2 == 0)  localbuf{n}[0
 
 
 
-def find_line(content, target, filename):
+def covering_array(domains, strength):
+    """
+    A subset of the cross product of the domains, in which any combination of values of any `strength` domains appears at least once (t-wise covering array).
+    It is built greedily: each step adds the first combination of the cross product that covers most of the missing t-tuples, so the result only depends on the domains.
+    """
+    domains = [list(collections.OrderedDict.fromkeys(domain)) for domain in domains] # Without duplicates
+    candidates = list(itertools.product(*domains))
+    if strength <= 0 or strength >= len(domains):
+        return candidates
+    def tuples(combination):
+        return [(dims, tuple(combination[dim] for dim in dims)) for dims in itertools.combinations(range(len(domains)), strength)]
+    missing = set(pair for combination in candidates for pair in tuples(combination))
+    res = []
+    while len(missing) > 0:
+        best = max(candidates, key=lambda combination: len(missing.intersection(tuples(combination)))) # The first one in case of tie
+        res.append(best)
+        missing.difference_update(tuples(best))
+    return sorted(res, key=candidates.index) # In the order of the full loop
+
+# The covering arrays of the generator loops (see covered()), and the combinations that they skipped in this process
+covering_arrays = {}
+skipped = []
+
+def covered(loop, combination, domains):
+    """
+    Whether that combination of the domains of a generator loop has to be generated. That's always the case, unless a covering strength t is given in the MBI_COVERING_STRENGTH
+    environment variable (see the --covering-strength option of MBI.py): only a t-wise covering array of the domains is then generated, and the skipped combinations are recorded.
+    """
+    strength = int(os.environ.get('MBI_COVERING_STRENGTH', '0'))
+    if strength <= 0:
+        return True
+    if (loop, strength) not in covering_arrays:
+        covering_arrays[(loop, strength)] = set(covering_array(domains, strength))
+    if tuple(combination) in covering_arrays[(loop, strength)]:
+        return True
+    skipped.append(f"{loop}: {' x '.join(combination)}")
+    return False
+
+def find_line(lines, target, filename):
+    """The number of the first line (among the given ones) that mentions that target, not counting the @{line:target}@ variables."""
+    if target not in line_patterns:
+        line_patterns[target] = re.compile(f'[^:]{target}')
     res = 1
-    for line in content.split('\n'):
-        if re.search(f'[^:]{target}', line):
+    for line in lines:
+        if line_patterns[target].search(line):
             #print(f'Found {target} at {line}')
             return res
         res += 1
     raise ValueError(f"Line target {target} not found in {filename}.")
 
+line_patterns = {}
+
+# The codes written by make_file() in this process (see run_generator() in MBIutils.py)
+generated = []
+
+# The variables of the templates: @{name}@, and @{kind:target}@ such as @{line:MBIERROR}@
+variable = re.compile(r'@\{([^@:]*)\}@|@\{([^:@]*):([^@]*)\}@')
+
+parsed_templates = {}
+def parse_template(template):
+    """Split that template into a list of segments: plain strings, ('var', name) and (kind, target) tuples. Each template is only parsed once."""
+    if template not in parsed_templates:
+        segments = []
+        pos = 0
+        for m in variable.finditer(template):
+            if m.start() > pos:
+                segments.append(template[pos:m.start()])
+            segments.append(('var', m.group(1)) if m.group(1) is not None else (m.group(2), m.group(3)))
+            pos = m.end()
+        if pos < len(template):
+            segments.append(template[pos:])
+        parsed_templates[template] = segments
+    return parsed_templates[template]
+
+def render(segments, replace, output):
+    """Append the segments of a template to the output list, with the value of its variables (that may use variables too). The line targets are kept as (kind, target) tuples."""
+    for segment in segments:
+        if type(segment) is str:
+            output.append(segment)
+        elif segment[0] == 'var':
+            if segment[1] not in replace:
+                raise ValueError(f"Variable {segment[1]} used in template, but not defined.")
+            value = replace[segment[1]]
+            if '\\' in value: # The values are processed as re.sub() replacement strings, whose escapes (such as \\n) are interpreted
+                value = re.sub('', value, '', count=1)
+            render(parse_template(value), replace, output)
+        elif segment[0] == 'line':
+            output.append(segment)
+        else:
+            raise ValueError(f"Unknown variable kind: {segment[0]}:{segment[1]}")
 
 def make_file(template, filename, replace):
-    output = template
     filename = filename.replace("_MPI_", "_")
     replace['filename'] = filename
-    # Replace all variables that don't have a ':' in their name
-    while re.search(r'@\{[^@:]*\}@', output):
-        m = re.search(r'@\{([^@:]*)\}@', output)
-        target = m.group(1)
-        #print(f"Replace @{{{target}}}@")
-        if target in replace.keys():
-            output = re.sub(fr'@\{{{target}\}}@', replace[target], output)
-            #print(f"Replace {target} -> {replace[target]}")
-        else:
-            raise ValueError(f"Variable {target} used in template, but not defined.")
-    # Now replace all variables with a ':' in their name: line targets are like that, and we don't want to resolve them before the others change the lines
-    while re.search(r'@\{([^:@]*):([^@]*)\}@', output):
-        m = re.search(r'@\{([^:@]*):([^@]*)\}@', output)
-        (kind, target) = (m.group(1), m.group(2))
-        if kind == 'line':
-            replace = f'{find_line(output, target, filename)}'
-            #print(f"Replace @{{line:{target}}}@ with '{replace}'")
-            output = re.sub(fr'@\{{line:{target}\}}@', replace, output)
-        else:
-            raise ValueError(f"Unknown variable kind: {kind}:{target}")
+    # Substitute all variables in a single pass over the parsed template
+    output = []
+    render(parse_template(template), replace, output)
+    # Then resolve the line targets, from the lines of the code with all other variables substituted
+    lines = None
+    numbers = {}
+    for segment in output:
+        if type(segment) is tuple and segment[1] not in numbers:
+            if lines is None:
+                lines = ''.join(part if type(part) is str else f'@{{{part[0]}:{part[1]}}}@' for part in output).split('\n')
+            numbers[segment[1]] = f'{find_line(lines, segment[1], filename)}'
+    output = ''.join(part if type(part) is str else numbers[part[1]] for part in output)
 
     if os.path.exists(filename):
         with open(filename, 'r') as file:
@@ -472,6 +546,16 @@ def make_file(template, filename, replace):
 
         print(f'WARNING: overwriting {filename}. Previously generated by: {prev}; regenerated by {now}')
 
-    # Ready to output it
+    # Ready to output it, along with its numbered view (as with `cat -n`) shown by the HTML reports
     with open(filename, 'w') as outfile:
         outfile.write(output)
+    with open(f'{filename}.txt', 'w') as outfile:
+        outfile.write(numbered_lines(output))
+    generated.append(filename)
+
+def numbered_lines(content):
+    lines = content.split('\n')
+    res = ''.join(f'{num:6d}\t{line}\n' for (num, line) in enumerate(lines[:-1], start=1))
+    if lines[-1] != '': # No final newline
+        res += f'{len(lines):6d}\t{lines[-1]}'
+    return res
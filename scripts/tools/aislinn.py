@@ -1,9 +1,13 @@
 import re
 import os
 import sys
+import shutil
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['MBI_MSG_RACE', 'No errors found', 'INFO: Found error', 'Unkn?own function call', 'Compilation of .*? raised an error', 'Traceback \\(most recent call last\\):']
+    final_verdicts = ["INFO: Found error '"]
+
     def identify(self):
         return "Aislinn wrapper"
 
@@ -77,20 +81,19 @@ class Tool(AbstractTool):
         execcmd = re.sub('\$infty_buffer', "--send-protocol=eager", execcmd)
         execcmd = re.sub('-np ', '-p=', execcmd)
 
-        ran = self.run_cmd(
-            buildcmd=f"aislinn-cc -g {filename} -o {binary}",
-            execcmd=execcmd,
-            cachefile=cachefile,
-            filename=filename,
-            binary=binary,
-            timeout=timeout,
-            batchinfo=batchinfo)
-
-        if os.path.exists("./report.html"):
-            os.rename("./report.html", f"{binary}_{id}.html")
-
-        if ran:
-            subprocess.run(f"rm -f {binary} vgcore.*", shell=True, check=True) # Save disk space ASAP
+        with self.scratch_dir() as tmpdirname:
+            self.run_cmd(
+                buildcmd=f"aislinn-cc -g {filename} -o {tmpdirname}/{binary}",
+                execcmd=execcmd,
+                cachefile=cachefile,
+                filename=filename,
+                binary=binary,
+                timeout=timeout,
+                cwd=tmpdirname,
+                batchinfo=batchinfo)
+
+            if os.path.exists(f"{tmpdirname}/report.html"):
+                shutil.copyfile(f"{tmpdirname}/report.html", f"{binary}_{id}.html")
 
     def teardown(self): # Remove generated cruft (binary files)
         subprocess.run("find -type f -a -executable | xargs rm -f", shell=True, check=True)
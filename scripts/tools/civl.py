@@ -3,6 +3,9 @@ import os
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['Compilation of .*? raised an error', 'cannot be invoked without MPI_Init', 'DEADLOCK', 'MBI_MSG_RACE', 'reaches an MPI collective routine', 'inconsistent datatype specification', 'is not consistent with the specified MPI_Datatype', 'different root with at least one of others', 'has a different MPI_Op', 'MPI message leak', 'MEMORY_LEAK', 'The standard properties hold for all executions', 'A CIVL internal error has occurred', 'kind: [A-Z_]*, certainty:', 'ASSERTION_VIOLATION', 'OUT_OF_BOUNDS', 'not yet implemented', 'doesn.t have a definition', 'Undeclared identifier', 'Incompatible types for operator', 'java.lang.[A-Za-z]*Exception']
+    final_verdicts = ['kind: DEADLOCK, certainty: PROVEABLE']
+
     def identify(self):
         return "CIVL wrapper"
 
@@ -38,15 +41,15 @@ class Tool(AbstractTool):
         execcmd = re.sub('\$infty_buffer', "", execcmd)
 
 
-        if self.run_cmd(buildcmd=None,
-                   execcmd=execcmd,
-                   cachefile=cachefile,
-                   filename=filename,
-                   binary=binary,
-                   timeout=timeout,
-                   batchinfo=batchinfo):
-            # the test was actually run
-            subprocess.run("killall -9 java 2>/dev/null", shell=True)
+        with self.scratch_dir() as tmpdirname: # CIVL writes its CIVLREP directory there
+            self.run_cmd(buildcmd=None,
+                       execcmd=execcmd,
+                       cachefile=cachefile,
+                       filename=filename,
+                       binary=binary,
+                       timeout=timeout,
+                       cwd=tmpdirname,
+                       batchinfo=batchinfo)
 
 
     def parse(self, cachefile):
@@ -6,6 +6,9 @@ import shutil
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['MBI_MSG_RACE', 'Detected a DEADLOCK in interleaving', 'resource leaks detected', 'Rank [0-9]: ', 'Fatal error in P?MPI', 'Invalid', 'ServerSocket.cpp', 'Assertion failed', 'Segmentation fault', 'warning generated', 'implicitly declaring', 'Command return code: ', 'Command killed by signal']
+    final_verdicts = ['Detected a DEADLOCK in interleaving']
+
     def identify(self):
         return "Hermes wrapper"
 
@@ -43,8 +46,8 @@ class Tool(AbstractTool):
             outfile.write(f'          "directory": "{self.rootdir}/logs/hermes",\n')
             outfile.write(f'          "file": "{self.rootdir}/logs/hermes/source.c"\n')
             outfile.write('}]')
-        subprocess.run("update-alternatives --set mpi /usr/bin/mpicc.mpich", shell=True, check=True)
-        subprocess.run("update-alternatives --set mpirun /usr/bin/mpirun.mpich", shell=True, check=True)
+        set_alternative("mpi", "/usr/bin/mpicc.mpich")
+        set_alternative("mpirun", "/usr/bin/mpirun.mpich")
 
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
         os.environ['PATH'] = f"{os.environ['PATH']}:/MBI-builds/hermes/bin/"
@@ -56,7 +59,7 @@ class Tool(AbstractTool):
         execcmd = re.sub('\$zero_buffer', "-b", execcmd)
         execcmd = re.sub('\$infty_buffer', "-g", execcmd)
 
-        with tempfile.TemporaryDirectory() as tmpdirname:
+        with self.scratch_dir() as tmpdirname:
             self.run_cmd(
                buildcmd=f"cp {filename} source.c &&"
                        +"/MBI-builds/hermes/clangTool/clangTool source.c &&"
@@ -70,7 +73,7 @@ class Tool(AbstractTool):
                batchinfo=batchinfo)
 
             if os.path.exists(f"{tmpdirname}/report.html"):
-               os.rename(f"{tmpdirname}/report.html", f"{binary}_{id}.html")
+               shutil.copyfile(f"{tmpdirname}/report.html", f"{binary}_{id}.html")
 
 #        subprocess.run("rm -f core vgcore.*", shell=True, check=True) # Save disk space ASAP
 #        subprocess.run("find -type f -a -executable | xargs rm -f", shell=True, check=True)
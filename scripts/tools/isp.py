@@ -3,6 +3,9 @@ import os
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['Compilation of .*? raised an error', 'ISP detected', 'Detected a DEADLOCK in interleaving', 'MBI_MSG_RACE', 'resource leaks detected', 'Attempting to use an MPI routine after finalizing MPI', 'Rank [0-9]: ', 'Fatal error in P?MPI', 'Invalid', 'Assertion failed', 'BAD TERMINATION OF ONE OF YOUR APPLICATION PROCESSES', 'Command killed by signal']
+    final_verdicts = ['ISP detected deadlock!!!', 'Detected a DEADLOCK in interleaving']
+
     def identify(self):
         return "ISP 0.3.1 wrapper"
 
@@ -30,8 +33,8 @@ class Tool(AbstractTool):
 
     def setup(self):
         os.environ['PATH'] = f"{os.environ['PATH']}:/MBI-builds/ISP/bin/"
-        subprocess.run("update-alternatives --set mpi /usr/bin/mpicc.mpich", shell=True, check=True)
-        subprocess.run("update-alternatives --set mpirun /usr/bin/mpirun.mpich", shell=True, check=True)
+        set_alternative("mpi", "/usr/bin/mpicc.mpich")
+        set_alternative("mpirun", "/usr/bin/mpirun.mpich")
 
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
         cachefile = f'{binary}_{id}'
@@ -43,17 +46,15 @@ class Tool(AbstractTool):
         execcmd = re.sub('\$infty_buffer', "-g", execcmd)
 
 
-        if self.run_cmd(buildcmd=f"ispcc -o {binary} {filename}",
-                   execcmd=execcmd,
-                   cachefile=cachefile,
-                   filename=filename,
-                   binary=binary,
-                   timeout=timeout,
-                   batchinfo=batchinfo):
-
-            # The test was actually run
-            print("\nClearing port after executing ISP\n")
-            subprocess.run("kill -9 $(lsof -t -i:9999) 2>/dev/null", shell=True)
+        with self.scratch_dir() as tmpdirname:
+            self.run_cmd(buildcmd=f"ispcc -o {tmpdirname}/{binary} {filename}",
+                       execcmd=execcmd,
+                       cachefile=cachefile,
+                       filename=filename,
+                       binary=binary,
+                       timeout=timeout,
+                       cwd=tmpdirname,
+                       batchinfo=batchinfo)
 
     def teardown(self): # Remove generated cruft (binary files)
         subprocess.run("find -type f -a -executable | xargs rm -f", shell=True, check=True)
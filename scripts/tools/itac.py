@@ -5,6 +5,8 @@ import distutils.spawn
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['mpiicc: not found', 'Compilation of .*? raised an error', 'MBI_MSG_RACE', 'ERROR: ', 'WARNING: ', 'Command return code: 0,', 'Command killed by signal']
+
     def identify(self):
         return "Intel TAC"
 
@@ -42,17 +44,16 @@ class Tool(AbstractTool):
         execcmd = re.sub('\$zero_buffer', "", execcmd)
         execcmd = re.sub('\$infty_buffer', "", execcmd)
 
-        ran = self.run_cmd(
-            buildcmd=f"mpiicc {filename} -O0 -g -o {binary}",
-            execcmd=execcmd,
-            cachefile=cachefile,
-            filename=filename,
-            binary=binary,
-            timeout=timeout,
-            batchinfo=batchinfo)
-
-        if ran:
-            subprocess.run(f"rm -f core vgcore.* {binary}", shell=True, check=True) # Save disk space ASAP
+        with self.scratch_dir() as tmpdirname: # The binary and core dumps stay there
+            self.run_cmd(
+                buildcmd=f"mpiicc {filename} -O0 -g -o {tmpdirname}/{binary}",
+                execcmd=execcmd,
+                cachefile=cachefile,
+                filename=filename,
+                binary=binary,
+                timeout=timeout,
+                cwd=tmpdirname,
+                batchinfo=batchinfo)
 
     def teardown(self):
         subprocess.run("find -type f -a -executable | xargs rm -f", shell=True, check=True) # Remove generated cruft (binary files)
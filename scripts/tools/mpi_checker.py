@@ -3,6 +3,8 @@ import os
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['no matching wait', 'no matching nonblocking call', 'error:', 'warning:', 'Missing wait', 'Unmatched wait', 'MPI Error']
+
     def identify(self):
         return "MPI-Checker wrapper"
 
@@ -20,6 +22,8 @@ class Tool(AbstractTool):
 
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
         cachefile = f'{binary}_{id}'
+        if self.prebuild_only: # Nothing to build ahead: the clang-tidy pass is part of the analysis, and the compile database is shared with the running test
+            return
 
         with open("/MBI/compile_commands.json", "w") as out:
             out.write(f'[{{"directory": "/MBI/", "command": "mpicc {filename} -I/usr/include/x86_64-linux-gnu/mpich/", "file": "{filename}"}}]')
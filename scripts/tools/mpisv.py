@@ -1,9 +1,13 @@
 import re
 import os
 import sys
+import shutil
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['Compilation of .*? raised an error', 'failed external call', 'found deadlock', 'MBI_MSG_RACE', 'klee: .*? Assertion `.*? failed.', 'No Violation detected by MPI-SV', 'Illegal instruction']
+    final_verdicts = ['found deadlock']
+
     def identify(self):
         return "MPI-SV wrapper"
 
@@ -25,24 +29,21 @@ class Tool(AbstractTool):
         execcmd = re.sub('\$zero_buffer', "", execcmd)
         execcmd = re.sub('\$infty_buffer', "", execcmd)
 
-        ran = self.run_cmd(
-            buildcmd=f"mpisvcc {filename} -o {binary}.bc",
-            execcmd=execcmd,
-            cachefile=cachefile,
-            filename=filename,
-            binary=binary,
-            timeout=timeout,
-            batchinfo=batchinfo)
-
-        if os.path.exists('klee-last') and not os.path.exists(f"{binary}_{id}-klee-out"):
-            os.rename(os.readlink('klee-last'), f"{binary}_{id}-klee-out")
-            os.remove('klee-last')
+        with self.scratch_dir() as tmpdirname:
+            ran = self.run_cmd(
+                buildcmd=f"mpisvcc {filename} -o {tmpdirname}/{binary}.bc",
+                execcmd=execcmd,
+                cachefile=cachefile,
+                filename=filename,
+                binary=binary,
+                timeout=timeout,
+                cwd=tmpdirname,
+                batchinfo=batchinfo)
 
-        # save disk space ASAP if ran
-        if ran:
-            subprocess.run("find -type f -a -executable | xargs rm -f", shell=True, check=True) # Remove generated cruft (binary files)
-            subprocess.run("find -name '*.bin' -o -name '*.istats' -o -name 'pid' -o -name '*.ll' | xargs rm -f", shell=True, check=True) # Remove cruft generated by Klee
-            subprocess.run("rm -rf klee-last core", shell=True, check=True)
+            # Keep the report of Klee, without its bulky cruft
+            if ran and os.path.exists(f'{tmpdirname}/klee-last'):
+                shutil.rmtree(f"{binary}_{id}-klee-out", ignore_errors=True)
+                shutil.copytree(os.path.realpath(f'{tmpdirname}/klee-last'), f"{binary}_{id}-klee-out", ignore=shutil.ignore_patterns('*.bin', '*.istats', 'pid', '*.ll'))
 
     def parse(self, cachefile):
         if os.path.exists(f'{cachefile}.timeout') or os.path.exists(f'logs/mpisv/{cachefile}.timeout'):
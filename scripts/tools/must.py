@@ -4,18 +4,11 @@ import tempfile
 import shutil
 from MBIutils import *
 
-def must_filter(line, process):
-    if re.search("ERROR: MUST detected a deadlock", line):
-        pid = process.pid
-        pgid = os.getpgid(pid)
-        try:
-            process.terminate()
-            # Send the signal to all the processes in the group. The command and everything it forked
-            os.killpg(pgid, signal.SIGTERM)
-        except ProcessLookupError:
-            pass  # Ok, it's gone now
-
 class V18(AbstractTool):
+    parallel_safe = True # MUST writes its must_temp directory and its MUST_Output.html report in the working directory, that is the scratch directory of the test
+    verdicts = ['MBI_MSG_RACE', 'Compilation of .*? raised an error', 'caught MPI error', 'Segmentation fault', 'caught signal nr', 'internal ABORT - process ']
+    final_verdicts = ['ERROR: MUST detected a deadlock']
+
     def identify(self):
         return "MUST v1.8.0 wrapper"
 
@@ -49,20 +42,18 @@ class V18(AbstractTool):
         os.environ['PATH'] = os.environ['PATH'] + ":/MBI-builds/MUST18/bin/"
         os.environ['OMPI_ALLOW_RUN_AS_ROOT'] = "1"
         os.environ['OMPI_ALLOW_RUN_AS_ROOT_CONFIRM'] = "1"
-        subprocess.run("update-alternatives --set mpi /usr/bin/mpicc.openmpi", shell=True, check=True)
-        subprocess.run("update-alternatives --set mpirun /usr/bin/mpirun.openmpi", shell=True, check=True)
+        set_alternative("mpi", "/usr/bin/mpicc.openmpi")
+        set_alternative("mpirun", "/usr/bin/mpirun.openmpi")
 
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
         cachefile = f'{binary}_{id}'
 
-        subprocess.run("killall -9 mpirun 2>/dev/null", shell=True)
-
         execcmd = re.sub("mpirun", "mustrun --must:distributed", execcmd)
         execcmd = re.sub('\${EXE}', f'./{binary}', execcmd)
         execcmd = re.sub('\$zero_buffer', "", execcmd)
         execcmd = re.sub('\$infty_buffer', "", execcmd)
 
-        with tempfile.TemporaryDirectory() as tmpdirname:
+        with self.scratch_dir() as tmpdirname:
             ran = self.run_cmd(
                     buildcmd=f"mpicc {filename} -o {tmpdirname}/{binary}",
                     execcmd=execcmd,
@@ -71,8 +62,7 @@ class V18(AbstractTool):
                     binary=binary,
                     timeout=timeout,
                     batchinfo=batchinfo,
-                    cwd=tmpdirname,
-                    read_line_lambda=must_filter)
+                    cwd=tmpdirname)
 
             if os.path.isfile(f"{tmpdirname}/MUST_Output.html"):
                 shutil.copyfile(f"{tmpdirname}/MUST_Output.html", f"{cachefile}.html")
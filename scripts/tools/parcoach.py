@@ -3,6 +3,8 @@ import os
 from MBIutils import *
 
 class Tool(AbstractTool):
+    verdicts = ['MBI_MSG_RACE', 'Compilation of .*? raised an error', 'warning\\(s\\) issued', 'missing info for external function']
+
     def identify(self):
         return "PARCOACH wrapper"
 
@@ -32,16 +34,16 @@ class Tool(AbstractTool):
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
         cachefile = f'{binary}_{id}'
 
-        self.run_cmd(
-            buildcmd=f"clang -c -g -emit-llvm {filename} -I/usr/lib/x86_64-linux-gnu/openmpi/include/ -o {binary}.bc",
-            execcmd=f"/MBI-builds/parcoach/parcoach -check-mpi {binary}.bc -o /dev/null",
-            cachefile=cachefile,
-            filename=filename,
-            binary=binary,
-            timeout=timeout,
-            batchinfo=batchinfo)
-
-        subprocess.run("rm -f *.bc core", shell=True, check=True)
+        with self.scratch_dir() as tmpdirname:
+            self.run_cmd(
+                buildcmd=f"clang -c -g -emit-llvm {filename} -I/usr/lib/x86_64-linux-gnu/openmpi/include/ -o {tmpdirname}/{binary}.bc",
+                execcmd=f"/MBI-builds/parcoach/parcoach -check-mpi {binary}.bc -o /dev/null",
+                cachefile=cachefile,
+                filename=filename,
+                binary=binary,
+                timeout=timeout,
+                cwd=tmpdirname,
+                batchinfo=batchinfo)
 
     def parse(self, cachefile):
         if os.path.exists(f'{cachefile}.timeout') or os.path.exists(f'logs/parcoach/{cachefile}.timeout'):
@@ -11,6 +11,9 @@ class Tool(AbstractTool):
     version = ""
     install_path = "/usr"
     exec_cfg = "--cfg=smpi/finalization-barrier:on --cfg=smpi/list-leaks:10 --cfg=model-check/max-depth:10000 --cfg=smpi/pedantic:true"
+    parallel_safe = True # Each test is compiled and run in its own temporary directory
+    verdicts = ['Compilation of .*? raised an error', 'MBI_MSG_RACE', 'MC is currently not supported here', 'Collective communication mismatch', 'DEADLOCK DETECTED', 'returned MPI_ERR', 'Not yet implemented', 'CRASH IN THE PROGRAM', 'Probable memory leaks in your code', 'DFS exploration ended.', 'No property violation found.', 'Segmentation fault.', 'Execution failed with code']
+    final_verdicts = ['DEADLOCK DETECTED', 'Collective communication mismatch']
 
     def identify(self):
         return "SimGrid wrapper"
@@ -48,12 +51,14 @@ class Tool(AbstractTool):
     def setup(self):
         os.environ['VERBOSE'] = '1'
         if not os.path.exists("/MBI/cluster.xml"):
-            with open('/MBI/cluster.xml', 'w') as outfile:
+            # Write it aside and rename it, so that the concurrent tests never see a partial file
+            with open(f'/MBI/cluster.xml.{os.getpid()}', 'w') as outfile:
                 outfile.write("<?xml version='1.0'?>\n")
                 outfile.write("<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n")
                 outfile.write('<platform version="4.1">\n')
                 outfile.write(' <cluster id="acme" prefix="node-" radical="0-99" suffix="" speed="1Gf" bw="125MBps" lat="50us"/>\n')
                 outfile.write('</platform>\n')
+            os.replace(f'/MBI/cluster.xml.{os.getpid()}', '/MBI/cluster.xml')
 
 
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
@@ -64,7 +69,7 @@ class Tool(AbstractTool):
         execcmd = execcmd.replace('$zero_buffer', "--cfg=smpi/buffering:zero")
         execcmd = execcmd.replace('$infty_buffer', "--cfg=smpi/buffering:infty")
 
-        with tempfile.TemporaryDirectory() as tmpdirname:
+        with self.scratch_dir() as tmpdirname:
             self.run_cmd(
                 buildcmd=f"{self.install_path}/bin/smpicc {filename} -trace-call-location -g -Wl,-znorelro -Wl,-znoseparate-code -o {tmpdirname}/{binary}",
                 execcmd=execcmd,
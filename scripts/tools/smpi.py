@@ -10,33 +10,34 @@ class Tool(tools.simgrid.Tool):
     def ensure_image(self):
         AbstractTool.ensure_image(self, "-x smpi")
 
-    def run(self, execcmd, filename, binary, id, timeout, batchinfo, extraargs=""):
+    def run(self, execcmd, filename, binary, id, timeout, batchinfo, extraargs="", extrafiles=[]):
+        """Run the test in its scratch directory, along with the platform file and the given extra files of the logs directory (symlinked there)."""
         cachefile = f'{binary}_{id}'
 
-        if not os.path.exists("cluster.xml"):
-            with open('cluster.xml', 'w') as outfile:
-                outfile.write("<?xml version='1.0'?>\n")
-                outfile.write("<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n")
-                outfile.write('<platform version="4.1">\n')
-                outfile.write(' <cluster id="acme" prefix="node-" radical="0-99" suffix="" speed="1Gf" bw="125MBps" lat="50us"/>\n')
-                outfile.write('</platform>\n')
-
         execcmd = re.sub("mpirun", f"smpirun {extraargs} -platform ./cluster.xml -analyze --cfg=smpi/finalization-barrier:on --cfg=smpi/list-leaks:10 --cfg=smpi/pedantic:true", execcmd)
         execcmd = re.sub('\${EXE}', binary, execcmd)
         execcmd = re.sub('\$zero_buffer', "", execcmd)
         execcmd = re.sub('\$infty_buffer', "", execcmd)
 
-        self.run_cmd(
-            buildcmd=f"smpicc {filename} -trace-call-location -g -Wl,-znorelro -Wl,-znoseparate-code -o {binary}",
-            execcmd=execcmd,
-            cachefile=cachefile,
-            filename=filename,
-            binary=binary,
-            timeout=timeout,
-            batchinfo=batchinfo)
+        with self.scratch_dir() as tmpdirname: # The binary, smpitmp-* files and core dumps stay there
+            with open(f'{tmpdirname}/cluster.xml', 'w') as outfile:
+                outfile.write("<?xml version='1.0'?>\n")
+                outfile.write("<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n")
+                outfile.write('<platform version="4.1">\n')
+                outfile.write(' <cluster id="acme" prefix="node-" radical="0-99" suffix="" speed="1Gf" bw="125MBps" lat="50us"/>\n')
+                outfile.write('</platform>\n')
+            for extrafile in extrafiles:
+                os.symlink(os.path.abspath(extrafile), f'{tmpdirname}/{extrafile}')
 
-        subprocess.run("find -type f -a -executable | xargs rm -f", shell=True, check=True) # Remove generated cruft (binary files)
-        subprocess.run("rm -f smpitmp-* core", shell=True, check=True)
+            self.run_cmd(
+                buildcmd=f"smpicc {filename} -trace-call-location -g -Wl,-znorelro -Wl,-znoseparate-code -o {tmpdirname}/{binary}",
+                execcmd=execcmd,
+                cachefile=cachefile,
+                filename=filename,
+                binary=binary,
+                timeout=timeout,
+                cwd=tmpdirname,
+                batchinfo=batchinfo)
 
     def parse(self, cachefile):
         if os.path.exists(f'{cachefile}.timeout') or os.path.exists(f'logs/smpi/{cachefile}.timeout'):
@@ -5,6 +5,9 @@ import subprocess
 from MBIutils import *
 
 class Tool(tools.smpi.Tool):
+    parallel_safe = False # The valgrind suppressions are fetched in the logs directory on first use
+    verdicts = tools.smpi.Tool.verdicts + ['ERROR SUMMARY: ']
+
     def identify(self):
         return "SimGrid MPI with Valgrind wrapper"
 
@@ -12,6 +15,9 @@ class Tool(tools.smpi.Tool):
         AbstractTool.ensure_image(self, "-x smpivg")
 
     def run(self, execcmd, filename, binary, id, timeout, batchinfo):
+        if self.prebuild_only: # The build does not need the suppressions, and the compile workers do not run from the logs directory (see prebuild_test())
+            tools.smpi.Tool.run(self, execcmd, filename, binary, id, timeout, batchinfo)
+            return
         if not os.path.exists('simgrid.supp'):
             if os.path.exists('../../simgrid.supp'):
                 print(f"\nCopying simgrid.supp from {os.getcwd()}/../.. to {os.getcwd()}.")
@@ -22,8 +28,7 @@ class Tool(tools.smpi.Tool):
                 subprocess.run("apt-get install -y wget", shell=True, check=True)
                 subprocess.run("wget 'https://framagit.org/simgrid/simgrid/-/raw/master/tools/simgrid.supp?inline=false' -O simgrid.supp", shell=True, check=True)
 
-        tools.smpi.Tool.run(self, execcmd, filename, binary, id, timeout, batchinfo, extraargs="-wrapper 'valgrind --leak-check=no --suppressions=simgrid.supp'")
-        subprocess.run("rm -f vgcore.*", shell=True, check=True) # Save disk space ASAP
+        tools.smpi.Tool.run(self, execcmd, filename, binary, id, timeout, batchinfo, extraargs="-wrapper 'valgrind --leak-check=no --suppressions=simgrid.supp'", extrafiles=['simgrid.supp'])
 
     def parse(self, cachefile):
         if os.path.exists(f'{cachefile}.timeout') or os.path.exists(f'logs/smpivg/{cachefile}.timeout'):